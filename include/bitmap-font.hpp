@@ -0,0 +1,150 @@
+#ifndef BITMAP_FONT_HPP
+#define BITMAP_FONT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace bitmap_font {
+
+// 5x7 glyphs in an 6x8 cell, so texts render without font files
+inline constexpr int GLYPH_WIDTH = 5;
+inline constexpr int GLYPH_HEIGHT = 7;
+inline constexpr int CELL_WIDTH = 6;
+inline constexpr int CELL_HEIGHT = 8;
+
+// rows top to bottom, bit 4 is the leftmost column
+using glyph_t = std::array<std::uint8_t, GLYPH_HEIGHT>;
+
+namespace details {
+
+struct GlyphDef {
+    char ch;
+    glyph_t rows;
+};
+
+inline constexpr GlyphDef GLYPH_DEFS[] = {
+    {'0', {0b01110, 0b10001, 0b10011, 0b10101, 0b11001, 0b10001, 0b01110}},
+    {'1', {0b00100, 0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110}},
+    {'2', {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b01000, 0b11111}},
+    {'3', {0b11111, 0b00010, 0b00100, 0b00010, 0b00001, 0b10001, 0b01110}},
+    {'4', {0b00010, 0b00110, 0b01010, 0b10010, 0b11111, 0b00010, 0b00010}},
+    {'5', {0b11111, 0b10000, 0b11110, 0b00001, 0b00001, 0b10001, 0b01110}},
+    {'6', {0b00110, 0b01000, 0b10000, 0b11110, 0b10001, 0b10001, 0b01110}},
+    {'7', {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b01000, 0b01000}},
+    {'8', {0b01110, 0b10001, 0b10001, 0b01110, 0b10001, 0b10001, 0b01110}},
+    {'9', {0b01110, 0b10001, 0b10001, 0b01111, 0b00001, 0b00010, 0b01100}},
+    {'A', {0b01110, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001}},
+    {'B', {0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110}},
+    {'C', {0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110}},
+    {'D', {0b11100, 0b10010, 0b10001, 0b10001, 0b10001, 0b10010, 0b11100}},
+    {'E', {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111}},
+    {'F', {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b10000}},
+    {'G', {0b01110, 0b10001, 0b10000, 0b10111, 0b10001, 0b10001, 0b01111}},
+    {'H', {0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001}},
+    {'I', {0b01110, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110}},
+    {'J', {0b00111, 0b00010, 0b00010, 0b00010, 0b00010, 0b10010, 0b01100}},
+    {'K', {0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001}},
+    {'L', {0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111}},
+    {'M', {0b10001, 0b11011, 0b10101, 0b10101, 0b10001, 0b10001, 0b10001}},
+    {'N', {0b10001, 0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001}},
+    {'O', {0b01110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110}},
+    {'P', {0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000}},
+    {'Q', {0b01110, 0b10001, 0b10001, 0b10001, 0b10101, 0b10010, 0b01101}},
+    {'R', {0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001}},
+    {'S', {0b01111, 0b10000, 0b10000, 0b01110, 0b00001, 0b00001, 0b11110}},
+    {'T', {0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100}},
+    {'U', {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110}},
+    {'V', {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100}},
+    {'W', {0b10001, 0b10001, 0b10001, 0b10101, 0b10101, 0b10101, 0b01010}},
+    {'X', {0b10001, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b10001}},
+    {'Y', {0b10001, 0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100}},
+    {'Z', {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111}},
+    {':', {0b00000, 0b01100, 0b01100, 0b00000, 0b01100, 0b01100, 0b00000}},
+    {'.', {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b01100, 0b01100}},
+    {',', {0b00000, 0b00000, 0b00000, 0b00000, 0b01100, 0b00100, 0b01000}},
+    {'-', {0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000}},
+    {'+', {0b00000, 0b00100, 0b00100, 0b11111, 0b00100, 0b00100, 0b00000}},
+    {'=', {0b00000, 0b00000, 0b11111, 0b00000, 0b11111, 0b00000, 0b00000}},
+    {'_', {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111}},
+    {'/', {0b00001, 0b00010, 0b00010, 0b00100, 0b01000, 0b01000, 0b10000}},
+    {'%', {0b11000, 0b11001, 0b00010, 0b00100, 0b01000, 0b10011, 0b00011}},
+    {'(', {0b00010, 0b00100, 0b01000, 0b01000, 0b01000, 0b00100, 0b00010}},
+    {')', {0b01000, 0b00100, 0b00010, 0b00010, 0b00010, 0b00100, 0b01000}},
+    {'?', {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b00000, 0b00100}},
+    {' ', {0, 0, 0, 0, 0, 0, 0}},
+};
+
+using glyph_table_t = std::array<glyph_t, 128>;
+
+constexpr glyph_table_t makeGlyphTable() noexcept {
+    glyph_table_t table {};
+    glyph_t unknown {};
+    for (const auto& def : GLYPH_DEFS) {
+        if (def.ch == '?') unknown = def.rows;
+    }
+    for (auto& g : table) {
+        g = unknown;
+    }
+    for (const auto& def : GLYPH_DEFS) {
+        table[static_cast<std::size_t>(def.ch)] = def.rows;
+    }
+    // lowercase is drawn as uppercase
+    for (char c = 'a'; c <= 'z'; ++c) {
+        table[static_cast<std::size_t>(c)] = table[static_cast<std::size_t>(c - 'a' + 'A')];
+    }
+    return table;
+}
+
+inline constexpr glyph_table_t GLYPH_TABLE = makeGlyphTable();
+
+} // namespace details
+
+constexpr const glyph_t& glyph(char ch) noexcept {
+    auto idx = static_cast<unsigned char>(ch);
+    return details::GLYPH_TABLE[idx < 128 ? idx : '?'];
+}
+
+// size of one glyph pixel for a character size in pixels
+constexpr float pixelSize(unsigned characterSize) noexcept {
+    return static_cast<float>(characterSize) / CELL_HEIGHT;
+}
+
+// {width, height} of the inked area
+constexpr std::array<float, 2> measure(std::string_view text, unsigned characterSize) noexcept {
+    if (text.empty()) return {0.f, 0.f};
+    auto px = pixelSize(characterSize);
+    return {
+        (text.size() * CELL_WIDTH - (CELL_WIDTH - GLYPH_WIDTH)) * px,
+        GLYPH_HEIGHT * px
+    };
+}
+
+/**
+ * @brief Calls func(x, y, side) for every lit glyph pixel of text drawn
+ * with its top-left corner at (x, y).
+ */
+template <typename F>
+constexpr void forEachPixel(std::string_view text, unsigned characterSize,
+                            float x, float y, F&& func) {
+    auto px = pixelSize(characterSize);
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const auto& rows = glyph(text[i]);
+        float cellX = x + i * CELL_WIDTH * px;
+        for (int row = 0; row < GLYPH_HEIGHT; ++row) {
+            for (int col = 0; col < GLYPH_WIDTH; ++col) {
+                if (rows[row] & (1 << (GLYPH_WIDTH - 1 - col))) {
+                    func(cellX + col * px, y + row * px, px);
+                }
+            }
+        }
+    }
+}
+
+static_assert(glyph('a') == glyph('A'));
+static_assert(glyph('\x7f') == glyph('?'));
+
+} // namespace bitmap_font
+
+#endif // BITMAP_FONT_HPP
@@ -0,0 +1,96 @@
+#ifndef BOARD_EVAL_HPP
+#define BOARD_EVAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "placement-search.hpp"
+
+namespace board_eval {
+
+/**
+ * @brief What the usual heuristics count on a board of locked blocks.
+ */
+struct Features {
+    // the sum of the column heights
+    std::int32_t aggregateHeight = 0;
+    // empty cells with a block above them in their column
+    std::int32_t holes = 0;
+    // the sum of the height differences of neighbouring columns
+    std::int32_t bumpiness = 0;
+    // 1 + 2 + ... + d for every d cells deep run of empty cells with a
+    // block or a wall on both sides
+    std::int32_t wells = 0;
+    // a block and an empty cell side by side, the walls are blocks
+    std::int32_t rowTransitions = 0;
+    // a block and an empty cell one above the other, the floor is blocks
+    std::int32_t columnTransitions = 0;
+
+    bool operator==(const Features&) const = default;
+};
+
+/**
+ * @brief Boards of one size laid out for the kernels: boards are grouped
+ * by LANES, and row y of every board of a group is stored next to row y
+ * of the others, so a vector load takes the same row of several boards.
+ */
+class BoardBatch {
+public:
+    static constexpr std::size_t LANES = 4;
+    // the deepest well the kernels count
+    static constexpr std::size_t MAX_HEIGHT = 127;
+
+public:
+    BoardBatch(std::size_t width, std::size_t height);
+
+public:
+    // keeps the memory for the next boards
+    void clear();
+    // of the batch's size
+    void add(const placement_search::Board& board);
+
+    std::size_t size() const;
+    std::size_t width() const;
+    std::size_t height() const;
+    placement_search::row_t emptyRow() const;
+    // rows of group g are at data() + g * height() * LANES, row by row,
+    // the missing boards of the last group are empty
+    const placement_search::row_t* data() const;
+    // the rows above it are empty in every board of group g
+    std::size_t firstRow(std::size_t group) const;
+
+private:
+    std::size_t width_;
+    std::size_t height_;
+    placement_search::row_t emptyRow_;
+    std::size_t size_ = 0;
+    std::vector<placement_search::row_t> rows_;
+    std::vector<std::size_t> firstRows_;
+};
+
+enum class Kernel : std::uint8_t {
+    // std::popcount on a row at a time
+    SCALAR = 0,
+    // SSSE3, two boards a vector
+    SSE,
+    // four boards a vector
+    AVX2,
+};
+
+// whether this build and this CPU can run the kernel
+bool isSupported(Kernel kernel);
+// the fastest supported kernel, checked once
+Kernel bestKernel();
+const char* kernelName(Kernel kernel);
+
+// the features of every board of the batch, out.size() >= batch.size();
+// the kernel must be supported
+void evaluate(const BoardBatch& batch, std::span<Features> out, Kernel kernel = bestKernel());
+// one board with the scalar kernel, of any height
+Features evaluate(const placement_search::Board& board);
+
+} // namespace board_eval
+
+#endif // BOARD_EVAL_HPP
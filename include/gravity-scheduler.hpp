@@ -0,0 +1,133 @@
+#ifndef GRAVITY_SCHEDULER_HPP
+#define GRAVITY_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "observer-n-subject.hpp"
+
+namespace gravity_scheduler {
+
+using duration_t = std::chrono::steady_clock::duration;
+using time_point_t = std::chrono::steady_clock::time_point;
+
+/**
+ * @brief Time between two gravity ticks on a given level.
+ */
+class GravityCurve {
+public:
+    virtual duration_t period(int level) const = 0;
+    virtual ~GravityCurve() {}
+};
+
+class ConstantGravityCurve : public GravityCurve {
+public:
+    explicit ConstantGravityCurve(duration_t period);
+    duration_t period(int level) const override;
+
+private:
+    duration_t period_;
+};
+
+// (0.8 - (level - 1) * 0.007) ^ (level - 1) seconds per row, level >= 1
+class GuidelineGravityCurve : public GravityCurve {
+public:
+    duration_t period(int level) const override;
+};
+
+/**
+ * @brief The time deadlines are set on and the waits for them.
+ */
+class Clock {
+public:
+    virtual time_point_t now() const = 0;
+    // waits on cv, lk held, until ready() or the deadline; returns ready()
+    virtual bool waitUntil(
+        std::unique_lock<std::mutex>& lk, std::condition_variable& cv,
+        time_point_t deadline, const std::function<bool()>& ready) = 0;
+    virtual ~Clock() {}
+};
+
+class SteadyClock final : public Clock {
+public:
+    time_point_t now() const override;
+    bool waitUntil(
+        std::unique_lock<std::mutex>& lk, std::condition_variable& cv,
+        time_point_t deadline, const std::function<bool()>& ready) override;
+};
+
+/**
+ * @brief How late the ticks fired relative to their deadlines.
+ */
+struct TickStats {
+    std::uint64_t ticks = 0;
+    // ticks skipped because the previous one overran the whole period
+    std::uint64_t skippedTicks = 0;
+    duration_t lastLateness {0};
+    duration_t maxLateness {0};
+    duration_t totalLateness {0};
+
+    duration_t meanLateness() const;
+};
+
+/**
+ * @brief Calls onTick on absolute deadlines spaced by the curve's period, so
+ * the time spent in onTick does not shift later ticks.
+ *
+ * run() blocks the calling thread until stop(). Pauses on
+ * USER_ASKED_PAUSE_GAME, stops on USER_ASKED_CLOSE_GAME and GAME_FINISH.
+ */
+class GravityScheduler final : public observer_n_subject::IObserver {
+public:
+    GravityScheduler(
+        std::function<void()> onTick,
+        std::shared_ptr<GravityCurve> curve,
+        int level = 1,
+        int softDropMultiplier = 20,
+        std::shared_ptr<Clock> clock = std::make_shared<SteadyClock>());
+
+public:
+    void run();
+    void stop();
+    void pause();
+    void resume();
+    bool isPaused() const;
+
+    void setLevel(int level);
+    int level() const;
+    // while on, the period is divided by the soft drop multiplier
+    void setSoftDrop(bool isOn);
+
+    TickStats tickStats() const;
+
+// observer
+public:
+    void update(
+        observer_n_subject::ISubject& subject, observer_n_subject::EventType event) override;
+
+private:
+    duration_t period_() const;
+
+private:
+    std::function<void()> onTick_;
+    std::shared_ptr<GravityCurve> curve_;
+    std::shared_ptr<Clock> clock_;
+    int level_;
+    int softDropMultiplier_;
+    bool isSoftDrop_ = false;
+    bool isPaused_ = false;
+    bool isStopped_ = false;
+    // set when the period changed and the next deadline must be recomputed
+    bool isPeriodChanged_ = false;
+    TickStats stats_;
+    mutable std::mutex mut_;
+    std::condition_variable cv_;
+};
+
+} // namespace gravity_scheduler
+
+#endif // GRAVITY_SCHEDULER_HPP
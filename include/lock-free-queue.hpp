@@ -0,0 +1,179 @@
+#ifndef LOCK_FREE_QUEUE_HPP
+#define LOCK_FREE_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace lock_free_queue {
+
+inline constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Bounded multi-producer single-consumer ring buffer.
+ *
+ * Every cell carries a sequence number (D. Vyukov's bounded queue):
+ * producers claim a cell with a CAS on the head, the single consumer
+ * owns the tail and never contends. Producers never take a lock unless
+ * the consumer sleeps in waitPop().
+ */
+template <typename T, std::size_t Capacity = 256>
+class LockFreeQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+    static_assert(std::is_default_constructible_v<T>);
+    static_assert(std::is_nothrow_move_assignable_v<T>);
+
+public:
+    LockFreeQueue() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+public:
+    // producers
+    bool tryPush(const T& val) {
+        auto pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto& cell = cells_[pos & MASK];
+            auto seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = val;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    wakeConsumer_();
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // spins while the queue is full
+    void push(const T& val) {
+        while (!tryPush(val)) {
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    // consumer, only one thread at a time
+    bool tryPop(T& val) {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        auto& cell = cells_[pos & MASK];
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        val = std::move(cell.value);
+        cell.sequence.store(pos + Capacity, std::memory_order_release);
+        tail_.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // pops up to maxCount values into out, returns how many were popped
+    template <typename OutputIt>
+    std::size_t tryPopBatch(OutputIt out, std::size_t maxCount) {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        std::size_t count = 0;
+        for (; count < maxCount; ++count, ++pos) {
+            auto& cell = cells_[pos & MASK];
+            if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            *out++ = std::move(cell.value);
+            cell.sequence.store(pos + Capacity, std::memory_order_release);
+        }
+        tail_.store(pos, std::memory_order_relaxed);
+        return count;
+    }
+
+    void waitPop(T& val) {
+        while (!tryPop(val)) {
+            sleep_([this] { return !empty_(); }, nullptr);
+        }
+    }
+
+    // false if nothing arrived before the timeout
+    template <typename Rep, typename Period>
+    bool waitPopFor(T& val, std::chrono::duration<Rep, Period> timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!tryPop(val)) {
+            if (!sleep_([this] { return !empty_(); }, &deadline)) {
+                return tryPop(val);
+            }
+        }
+        return true;
+    }
+
+    // exact for the consumer while no producer is pushing
+    std::size_t sizeApprox() const {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        auto head = head_.load(std::memory_order_relaxed);
+        return head > tail ? head - tail : 0;
+    }
+
+private:
+    bool empty_() const {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        return cells_[pos & MASK].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    // false on timeout
+    template <typename Pred>
+    bool sleep_(Pred ready, const std::chrono::steady_clock::time_point* deadline) {
+        std::unique_lock<std::mutex> lk{sleepMut_};
+        isConsumerSleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool res = true;
+        if (deadline) {
+            res = sleepCv_.wait_until(lk, *deadline, ready);
+        } else {
+            sleepCv_.wait(lk, ready);
+        }
+        isConsumerSleeping_.store(false, std::memory_order_relaxed);
+        return res;
+    }
+
+    void wakeConsumer_() {
+        // pairs with the fence in sleep_(): either the consumer sees
+        // the new value in its predicate, or we see it sleeping
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (isConsumerSleeping_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lk{sleepMut_};
+            sleepCv_.notify_one();
+        }
+    }
+
+private:
+    static constexpr std::size_t MASK = Capacity - 1;
+
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_ = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_ = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic_bool isConsumerSleeping_ = false;
+    std::mutex sleepMut_;
+    std::condition_variable sleepCv_;
+    alignas(CACHE_LINE_SIZE) std::array<Cell, Capacity> cells_;
+};
+
+} // namespace lock_free_queue
+
+#endif // LOCK_FREE_QUEUE_HPP
@@ -0,0 +1,142 @@
+#ifndef LOOKAHEAD_BOT_HPP
+#define LOOKAHEAD_BOT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stop_token>
+#include <vector>
+
+#include "board-eval.hpp"
+#include "placement-search.hpp"
+#include "simulation.hpp"
+#include "task-pool.hpp"
+#include "tetris-game-model.hpp"
+#include "tetromino.hpp"
+#include "transposition-table.hpp"
+
+namespace lookahead_bot {
+
+/**
+ * @brief How much a board feature is worth, higher values are better.
+ */
+struct Weights {
+    double aggregateHeight = -0.510066;
+    double linesCleared = 0.760666;
+    double holes = -0.35663;
+    double bumpiness = -0.184483;
+    // not weighed by default
+    double wells = 0.0;
+    double rowTransitions = 0.0;
+    double columnTransitions = 0.0;
+};
+
+// the lines that were cleared on the way count apart
+double featuresValue(const board_eval::Features& features, const Weights& weights);
+double evaluateBoard(const placement_search::Board& board, const Weights& weights);
+
+struct SearchOptions {
+    // tetrominoes placed ahead, the current one included
+    int depth = 3;
+    // placements of a tetromino searched deeper, the best by evaluateBoard()
+    std::size_t beamWidth = 8;
+    // best values of boards and tetrominoes cached across decisions,
+    // 0 caches none
+    std::size_t tableEntries = 1 << 18;
+};
+
+struct Decision {
+    placement_search::Placement placement;
+    double value = 0.0;
+    // the deepest depth searched to the end, 0 if there was no placement
+    int depth = 0;
+};
+
+/**
+ * @brief Expectimax over placements. The next tetromino is unknown, so
+ * every type of it is searched and their best values averaged.
+ *
+ * Deepens one tetromino at a time and keeps the decision of the last
+ * depth searched to the end. Subtrees run as tasks of the pool, a stop
+ * request abandons the depth in progress.
+ *
+ * The same board and tetromino come up again and again, the tetrominoes
+ * of a path can be placed in another order; their values go to a
+ * transposition table keyed by the Zobrist hash of the board. A cached
+ * value is the value the subtree would give again, so the decisions do
+ * not depend on the table nor on the threads.
+ */
+class LookaheadSearch {
+public:
+    LookaheadSearch(
+        task_pool::TaskPool& pool, Weights weights = {}, SearchOptions options = {});
+
+public:
+    // the first depth is searched to the end whatever the stop token says
+    Decision decide(
+        const placement_search::Board& board,
+        const tetrominoes::Tetromino& tetromino,
+        std::stop_token stop = {});
+    // placement searches since construction, safe to call from any thread
+    std::uint64_t nodesSearched() const;
+    // values taken from the table since construction
+    std::uint64_t tableHits() const;
+
+private:
+    struct Candidate {
+        placement_search::Placement placement;
+        double value = 0.0;
+    };
+
+    // placements of the tetromino, the best first, values of one tetromino ahead
+    void rankPlacements_(
+        const placement_search::Board& board,
+        const tetrominoes::Tetromino& tetromino,
+        std::vector<Candidate>& out);
+    // depth tetrominoes of unknown types still to place
+    double expectedValue_(
+        const placement_search::Board& board, int depth, const std::stop_token& stop);
+    // from the table when it can
+    double bestValue_(
+        const placement_search::Board& board,
+        tetrominoes::TetrominoType type,
+        int depth,
+        const std::stop_token& stop);
+    double searchBestValue_(
+        const placement_search::Board& board,
+        tetrominoes::TetrominoType type,
+        int depth,
+        const std::stop_token& stop);
+
+private:
+    task_pool::TaskPool& pool_;
+    Weights weights_;
+    SearchOptions options_;
+    std::optional<transposition_table::TranspositionTable> table_;
+    std::atomic<std::uint64_t> nodesSearched_ = 0;
+    std::atomic<std::uint64_t> tableHits_ = 0;
+};
+
+/**
+ * @brief Moves the current tetromino where a LookaheadSearch decides,
+ * never stopped early, so the same seed plays the same game.
+ */
+class LookaheadPolicy : public simulation::Policy {
+public:
+    LookaheadPolicy(
+        task_pool::TaskPool& pool, Weights weights = {}, SearchOptions options = {});
+    void placeTetromino(tetris_game_model::TetrisGameModel& model) override;
+
+private:
+    LookaheadSearch search_;
+    placement_search::PlacementSearch placementSearch_;
+    std::vector<placement_search::Move> path_;
+};
+
+// the tetromino as the model spawns it on a field of that width
+tetrominoes::Tetromino spawnedTetromino(tetrominoes::TetrominoType type, std::size_t fieldWidth);
+
+} // namespace lookahead_bot
+
+#endif // LOOKAHEAD_BOT_HPP
@@ -0,0 +1,123 @@
+#ifndef PERF_STATS_HPP
+#define PERF_STATS_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace perf_stats {
+
+inline constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+struct Percentiles {
+    std::int64_t p50 = 0;
+    std::int64_t p99 = 0;
+    std::int64_t max = 0;
+    // samples the percentiles were taken over
+    std::size_t count = 0;
+};
+
+/**
+ * @brief The last Window samples of a quantity, recorded from any number
+ * of threads without locks or allocations.
+ *
+ * A writer claims a slot with one fetch_add and overwrites the oldest
+ * sample. A reader copies the window and may see a sample or two newer
+ * than the rest, which does not matter for percentiles.
+ */
+template <std::size_t Window = 256>
+class RollingSamples {
+    static_assert(Window > 0);
+
+public:
+    RollingSamples() = default;
+    RollingSamples(const RollingSamples&) = delete;
+    RollingSamples& operator=(const RollingSamples&) = delete;
+
+public:
+    void record(std::int64_t value) {
+        auto idx = next_.fetch_add(1, std::memory_order_relaxed);
+        samples_[idx % Window].store(value, std::memory_order_relaxed);
+    }
+
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> value) {
+        record(std::chrono::duration_cast<std::chrono::nanoseconds>(value).count());
+    }
+
+    Percentiles percentiles() const {
+        auto count = static_cast<std::size_t>(
+            std::min<std::uint64_t>(next_.load(std::memory_order_relaxed), Window));
+        if (count == 0) return {};
+        std::array<std::int64_t, Window> copy;
+        for (std::size_t i = 0; i < count; ++i) {
+            copy[i] = samples_[i].load(std::memory_order_relaxed);
+        }
+        auto first = copy.begin();
+        auto last = first + count;
+        auto at = [&](std::size_t rank) {
+            std::nth_element(first, first + rank, last);
+            return first[rank];
+        };
+        Percentiles res;
+        res.max = *std::max_element(first, last);
+        res.p99 = at((count * 99 + 99) / 100 - 1);
+        // nth_element left everything up to p99 in front of it
+        last = first + (count * 99 + 99) / 100;
+        res.p50 = at((count + 1) / 2 - 1);
+        res.count = count;
+        return res;
+    }
+
+private:
+    std::array<std::atomic<std::int64_t>, Window> samples_ {};
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> next_ = 0;
+};
+
+/**
+ * @brief What the perf HUD shows, times in nanoseconds.
+ */
+struct PerfStats {
+    static constexpr std::size_t WINDOW = 256;
+
+    // building and presenting one frame
+    RollingSamples<WINDOW> frameTime;
+    // one call into the model under modelMut
+    RollingSamples<WINDOW> modelUpdate;
+    // from a player input to the first frame showing a later snapshot
+    RollingSamples<WINDOW> inputLatency;
+    // events still queued when the controller takes one, a count
+    RollingSamples<WINDOW> queueDepth;
+    // waiting for modelMut
+    RollingSamples<WINDOW> lockWait;
+};
+
+/**
+ * @brief Runs func under mut and, if stats is set, records the wait into
+ * lockWait and the call into modelUpdate.
+ *
+ * Every thread that updates the model goes through this, so the HUD sees
+ * all of the contention for its mutex.
+ */
+template <typename F>
+void withSampledLock(PerfStats* stats, std::mutex& mut, F&& func) {
+    if (!stats) {
+        std::lock_guard<std::mutex> lk{mut};
+        func();
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lk{mut};
+    auto locked = std::chrono::steady_clock::now();
+    func();
+    stats->lockWait.record(locked - start);
+    stats->modelUpdate.record(std::chrono::steady_clock::now() - locked);
+}
+
+} // namespace perf_stats
+
+#endif // PERF_STATS_HPP
@@ -0,0 +1,139 @@
+#ifndef PLACEMENT_SEARCH_HPP
+#define PLACEMENT_SEARCH_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "tetris-game-model.hpp"
+#include "tetromino.hpp"
+
+namespace placement_search {
+
+using row_t = std::uint64_t;
+
+struct Placement;
+
+/**
+ * @brief Locked blocks of a field, a bitmask per row.
+ *
+ * Laid out like BitboardTetrominoMovement: bit (x + 1) of a row is column
+ * x, bit 0 and every bit from (width + 1) up are walls, rows()[height] is
+ * a solid floor.
+ */
+class Board {
+public:
+    // two bits of a row are taken by the walls
+    static constexpr std::size_t MAX_WIDTH = sizeof(row_t) * 8 - 2;
+
+public:
+    Board(std::size_t width, std::size_t height);
+
+public:
+    void set(std::size_t x, std::size_t y);
+    void reset(std::size_t x, std::size_t y);
+    bool test(std::size_t x, std::size_t y) const;
+    // sets the blocks of a tetromino resting at the placement and deletes
+    // the lines it filled, returns how many
+    std::size_t lock(tetrominoes::TetrominoType type, const Placement& placement);
+    std::size_t width() const;
+    std::size_t height() const;
+    // height() + 1 rows, the last one is the floor
+    std::span<const row_t> rows() const;
+    row_t emptyRow() const;
+    // zobrist::blockKey of every block xor-ed, kept up to date by the
+    // changes, so equal boards of one size hash the same
+    std::uint64_t hash() const;
+
+private:
+    // the blocks of a row, walls cleared, bit x is column x
+    std::uint64_t blocks_(row_t row) const;
+
+private:
+    std::size_t width_;
+    std::size_t height_;
+    row_t emptyRow_;
+    std::vector<row_t> rows_;
+    std::uint64_t hash_ = 0;
+};
+
+// the locked blocks of the model's field, without its current tetromino
+Board lockedBoard(const tetris_game_model::TetrisGameModel& model);
+
+/**
+ * @brief Where a tetromino comes to rest: the top-left corner of its
+ * bounding box and its rotation.
+ */
+struct Placement {
+    std::int16_t column = 0;
+    std::int16_t row = 0;
+    std::uint8_t rotation = 0;
+    // the search state it was found in, for PlacementSearch::path()
+    std::uint32_t state = 0;
+};
+
+// the same column, row and rotation, whichever search found them
+bool isSamePlacement(const Placement& a, const Placement& b);
+
+enum class Move : std::uint8_t {
+    LEFT = 0,
+    RIGHT,
+    ROTATE_RIGHT,
+    DOWN,
+};
+
+/**
+ * @brief Every resting placement a tetromino can reach by moving left,
+ * right, down and rotating right, with the rules of the movement engine.
+ *
+ * A breadth-first search over (rotation, column, row) with a visited
+ * bitset. Collisions are an AND per piece row against the board, nothing
+ * is moved on a field. The buffers are kept between searches, so a
+ * search allocates only while the board is bigger than ever before.
+ */
+class PlacementSearch {
+public:
+    // in the order they were found, valid until the next search
+    std::span<const Placement> search(
+        const Board& board, const tetrominoes::Tetromino& tetromino);
+    // appends the moves from the searched tetromino to the placement,
+    // which must come from the last search; a hard drop may replace the
+    // trailing downs
+    void path(const Placement& placement, std::vector<Move>& out) const;
+    std::size_t statesVisited() const;
+
+private:
+    struct PieceMask {
+        int width = 0;
+        int height = 0;
+        // at column 0, walls included
+        std::array<row_t, tetrominoes::BLOCKS_COUNT> rows {};
+    };
+
+    bool fits_(std::size_t rotation, int x, int y) const;
+    bool canRotate_(std::size_t rotation, int x, int y) const;
+    void visit_(std::size_t rotation, int x, int y, std::uint32_t from, Move move);
+    std::uint32_t state_(std::size_t rotation, int x, int y) const;
+
+private:
+    std::span<const row_t> rows_;
+    int width_ = 0;
+    int height_ = 0;
+    std::array<PieceMask, tetrominoes::ROTATIONS_COUNT> masks_;
+
+    std::vector<std::uint64_t> visited_;
+    std::vector<std::uint32_t> queue_;
+    std::vector<std::uint32_t> parents_;
+    std::vector<Move> moves_;
+    std::vector<Placement> placements_;
+    // rows on top without a locked block
+    int freeRows_ = 0;
+    std::uint32_t start_ = 0;
+    std::size_t statesVisited_ = 0;
+};
+
+} // namespace placement_search
+
+#endif // PLACEMENT_SEARCH_HPP
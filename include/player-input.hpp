@@ -1,12 +1,25 @@
 #ifndef PLAYER_INPUT_HPP
 #define PLAYER_INPUT_HPP
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 
+#include "lookahead-bot.hpp"
 #include "observer-n-subject.hpp"
+#include "placement-search.hpp"
+#include "task-pool.hpp"
+#include "tetris-game-model.hpp"
 
 namespace player_input {
 
@@ -36,6 +49,111 @@ private:
     std::shared_ptr<sf::RenderWindow> window_;
 };
 
+/**
+ * @brief Plays by itself. A LookaheadSearch on a thread of its own decides
+ * where each tetromino goes, pollInput() sends one move towards it at a
+ * time, planned again from wherever gravity has taken the tetromino.
+ *
+ * Close and pause come from the wrapped input, if there is one.
+ */
+class BotInput final : public IPlayerInput,
+                       public observer_n_subject::IObserver,
+                       public std::enable_shared_from_this<BotInput> {
+public:
+    BotInput(
+        std::shared_ptr<tetris_game_model::TetrisGameModel> model,
+        std::mutex& modelMut,
+        std::shared_ptr<IPlayerInput> humanInput = nullptr,
+        lookahead_bot::SearchOptions options = {},
+        std::chrono::milliseconds movePeriod = std::chrono::milliseconds(0));
+    ~BotInput() override;
+
+    BotInput(const BotInput&) = delete;
+    BotInput& operator=(const BotInput&) = delete;
+
+public:
+    void registerAsObserver();
+    void pollInput() override;
+    // the search for the falling tetromino keeps the best placement it has
+    // found so far; safe to call from any thread, e.g. on a gravity tick
+    void forceDecision();
+
+// observer
+public:
+    void update(
+        observer_n_subject::ISubject& subject, observer_n_subject::EventType event) override;
+
+private:
+    struct Job {
+        placement_search::Board board;
+        tetrominoes::Tetromino tetromino;
+        std::uint64_t id;
+        // made with the job, so a force before the thinker takes it counts
+        std::stop_source stop;
+    };
+
+    void think_();
+    void askDecision_(placement_search::Board board, const tetrominoes::Tetromino& tetromino);
+    void fireMove_(placement_search::Move move);
+
+private:
+    std::shared_ptr<tetris_game_model::TetrisGameModel> model_;
+    std::mutex& modelMut_;
+    std::shared_ptr<IPlayerInput> humanInput_;
+    std::chrono::milliseconds movePeriod_;
+    std::chrono::steady_clock::time_point lastMoveAt_;
+    bool isPaused_ = false;
+    // the tetromino the last job was asked for
+    std::uint64_t piece_ = ~std::uint64_t{0};
+    placement_search::PlacementSearch planner_;
+    std::vector<placement_search::Move> path_;
+
+    task_pool::TaskPool pool_;
+    lookahead_bot::LookaheadSearch search_;
+    // everything below is shared with the thinking thread
+    std::mutex jobMut_;
+    std::condition_variable jobCv_;
+    std::optional<Job> job_;
+    std::uint64_t lastJobId_ = 0;
+    std::optional<placement_search::Placement> decision_;
+    std::uint64_t decidedJobId_ = 0;
+    // of the last job asked for
+    std::stop_source stop_;
+    bool isStopped_ = false;
+    std::thread thinker_;
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+
+/**
+ * @brief Arrow keys from a POSIX terminal, put into raw mode for the 
+ * lifetime of the object. Tab pauses, q, Ctrl-C or end of input close.
+ */
+class TerminalInput final : public IPlayerInput {
+public:
+    explicit TerminalInput(int fd = 0);
+    ~TerminalInput() override;
+
+    TerminalInput(const TerminalInput&) = delete;
+    TerminalInput& operator=(const TerminalInput&) = delete;
+
+public:
+    void pollInput() override;
+
+private:
+    void parse_();
+
+private:
+    struct SavedMode;
+
+    int fd_;
+    std::unique_ptr<SavedMode> savedMode_;
+    // bytes read but not parsed yet, e.g. half of an escape sequence
+    std::string pending_;
+};
+
+#endif
+
 } // namespace player_input
 
 #endif // PLAYER_INPUT_HPP
\ No newline at end of file
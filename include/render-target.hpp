@@ -0,0 +1,70 @@
+#ifndef RENDER_TARGET_HPP
+#define RENDER_TARGET_HPP
+
+#include <memory>
+#include <span>
+#include <string_view>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/System/Vector2.hpp>
+
+namespace sf {
+class Text;
+} // namespace sf
+
+namespace render_target {
+
+/**
+ * @brief A line of text with its style.
+ */
+struct TextRun {
+    std::string_view text;
+    unsigned characterSize;
+    sf::Color color;
+    sf::Vector2f position;
+    // laid out with an sf::Font; nullptr means the built-in bitmap font
+    const sf::Text* sfText = nullptr;
+};
+
+class IRenderTarget;
+
+/**
+ * @brief Off-screen surface created by a target and composited back
+ * into a target of the same kind.
+ */
+class IRenderLayer {
+public:
+    virtual IRenderTarget& target() = 0;
+    virtual ~IRenderLayer() {}
+};
+
+/**
+ * @brief What IDrawable draws into.
+ */
+class IRenderTarget {
+public:
+    virtual sf::Vector2u size() const = 0;
+    virtual void clear(sf::Color color) = 0;
+    virtual void fillRect(sf::FloatRect rect, sf::Color color) = 0;
+    // a triangle list, every triangle filled with the colour of its first vertex
+    virtual void drawTriangles(
+        std::span<const sf::Vertex> vertices, sf::Vector2f offset) = 0;
+    virtual void drawText(const TextRun& text) = 0;
+    virtual void display() = 0;
+    // a GPU target draws from one thread at a time, the thread about to
+    // draw activates it after the previous one deactivated it
+    virtual bool setActive(bool) { return true; }
+
+    // nullptr if the target cannot make one
+    virtual std::unique_ptr<IRenderLayer> createLayer(sf::Vector2u size) = 0;
+    // the layer must come from createLayer() of a target of the same kind
+    virtual void drawLayer(IRenderLayer& layer, sf::Vector2f position) = 0;
+
+    virtual ~IRenderTarget() {}
+};
+
+} // namespace render_target
+
+#endif // RENDER_TARGET_HPP
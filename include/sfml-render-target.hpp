@@ -0,0 +1,46 @@
+#ifndef SFML_RENDER_TARGET_HPP
+#define SFML_RENDER_TARGET_HPP
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+
+#include "render-target.hpp"
+
+namespace render_target {
+
+/**
+ * @brief Forwards to an sf::RenderWindow or sf::RenderTexture.
+ */
+class SfmlRenderTarget final : public IRenderTarget {
+public:
+    explicit SfmlRenderTarget(sf::RenderWindow& window);
+    explicit SfmlRenderTarget(sf::RenderTexture& texture);
+
+public:
+    sf::Vector2u size() const override;
+    void clear(sf::Color color) override;
+    void fillRect(sf::FloatRect rect, sf::Color color) override;
+    void drawTriangles(
+        std::span<const sf::Vertex> vertices, sf::Vector2f offset) override;
+    void drawText(const TextRun& text) override;
+    void display() override;
+    bool setActive(bool isActive) override;
+
+    std::unique_ptr<IRenderLayer> createLayer(sf::Vector2u size) override;
+    void drawLayer(IRenderLayer& layer, sf::Vector2f position) override;
+
+private:
+    sf::RenderTarget& target_;
+    sf::RenderWindow* window_ = nullptr;
+    sf::RenderTexture* texture_ = nullptr;
+    // reused for bitmap-font text and rectangles
+    std::vector<sf::Vertex> scratch_;
+};
+
+} // namespace render_target
+
+#endif // SFML_RENDER_TARGET_HPP
@@ -0,0 +1,53 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <cstdint>
+#include <random>
+
+#include "tetris-game-model.hpp"
+
+namespace simulation {
+
+/**
+ * @brief Decides where the current tetromino goes.
+ */
+class Policy {
+public:
+    // rotates and shifts the current tetromino, the caller drops it
+    virtual void placeTetromino(tetris_game_model::TetrisGameModel& model) = 0;
+    virtual ~Policy() {}
+};
+
+// drops every tetromino where it spawned
+class DropPolicy : public Policy {
+public:
+    void placeTetromino(tetris_game_model::TetrisGameModel& model) override;
+};
+
+// a random rotation and column, the same choices for the same seed
+class RandomPolicy : public Policy {
+public:
+    explicit RandomPolicy(std::uint64_t seed);
+    void placeTetromino(tetris_game_model::TetrisGameModel& model) override;
+
+private:
+    std::mt19937_64 gen_;
+};
+
+struct GameResult {
+    std::uint64_t pieces = 0;
+    std::uint64_t lines = 0;
+    int score = 0;
+    bool isFinished = false;
+};
+
+/**
+ * @brief Places and hard drops tetrominoes until the game is over or 
+ * maxPieces were locked, 0 for no limit. No gravity, no rendering.
+ */
+GameResult playGame(
+    tetris_game_model::TetrisGameModel& model, Policy& policy, std::uint64_t maxPieces = 0);
+
+} // namespace simulation
+
+#endif // SIMULATION_HPP
@@ -0,0 +1,56 @@
+#ifndef SOFTWARE_RENDER_TARGET_HPP
+#define SOFTWARE_RENDER_TARGET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "render-target.hpp"
+
+namespace render_target {
+
+/**
+ * @brief Rasterises into an in-memory RGBA8 buffer, no display or GPU needed.
+ * 
+ * Pixels are covered when their centre is inside the shape, colours are 
+ * blended source-over. Text is always drawn with the built-in bitmap font.
+ */
+class SoftwareRenderTarget final : public IRenderTarget {
+public:
+    SoftwareRenderTarget(std::size_t width, std::size_t height);
+
+public:
+    sf::Vector2u size() const override;
+    void clear(sf::Color color) override;
+    void fillRect(sf::FloatRect rect, sf::Color color) override;
+    void drawTriangles(
+        std::span<const sf::Vertex> vertices, sf::Vector2f offset) override;
+    void drawText(const TextRun& text) override;
+    void display() override;
+
+    std::unique_ptr<IRenderLayer> createLayer(sf::Vector2u size) override;
+    void drawLayer(IRenderLayer& layer, sf::Vector2f position) override;
+
+public:
+    // row-major, 4 bytes per pixel
+    std::span<const std::uint8_t> pixels() const;
+    sf::Color pixel(std::size_t x, std::size_t y) const;
+    // binary PPM, alpha dropped
+    bool saveToPpm(const char* path) const;
+
+private:
+    void blendPixel_(std::size_t x, std::size_t y, sf::Color color);
+    void fillSpan_(std::size_t y, std::size_t fromX, std::size_t toX, sf::Color color);
+    void fillTriangle_(sf::Vector2f a, sf::Vector2f b, sf::Vector2f c, sf::Color color);
+
+private:
+    std::size_t width_;
+    std::size_t height_;
+    std::vector<std::uint8_t> pixels_;
+};
+
+} // namespace render_target
+
+#endif // SOFTWARE_RENDER_TARGET_HPP
@@ -0,0 +1,100 @@
+#ifndef TASK_POOL_HPP
+#define TASK_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lock-free-queue.hpp"
+
+namespace task_pool {
+
+class TaskGroup;
+
+/**
+ * @brief Worker threads with a deque of tasks each.
+ *
+ * A worker pushes and pops its own tasks at the back, so nested tasks run
+ * depth first and stay in its cache; an idle worker steals from the front
+ * of the others, where the biggest subtrees are. Threads outside the pool
+ * push to a deque of their own that every worker steals from.
+ */
+class TaskPool {
+public:
+    // threads - 1 workers, a thread waiting on a group works as the last one
+    explicit TaskPool(std::size_t threads = std::thread::hardware_concurrency());
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+public:
+    std::size_t threadCount() const;
+    // safe to call from any thread
+    std::uint64_t tasksRun() const;
+    std::uint64_t tasksStolen() const;
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> func;
+        TaskGroup* group = nullptr;
+    };
+
+    struct alignas(lock_free_queue::CACHE_LINE_SIZE) Worker {
+        std::mutex mut;
+        std::deque<Task> tasks;
+    };
+
+    void push_(Task task);
+    // runs one task of the pool if there is any
+    bool runOne_();
+    bool pop_(std::size_t self, Task& task);
+    void workerLoop_(std::size_t self);
+
+private:
+    // one per worker thread, the last one for the threads outside the pool
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<std::size_t> queued_ = 0;
+    std::atomic<std::uint64_t> tasksRun_ = 0;
+    std::atomic<std::uint64_t> tasksStolen_ = 0;
+    std::mutex sleepMut_;
+    std::condition_variable sleepCv_;
+    bool isStopped_ = false;
+};
+
+/**
+ * @brief Tasks to wait for together. wait() runs tasks of the pool while
+ * the group's are not finished, so groups nest without blocking a worker.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskPool& pool);
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+public:
+    void run(std::function<void()> func);
+    void wait();
+
+private:
+    friend class TaskPool;
+
+    TaskPool& pool_;
+    std::atomic<std::size_t> pending_ = 0;
+};
+
+} // namespace task_pool
+
+#endif // TASK_POOL_HPP
@@ -0,0 +1,109 @@
+#ifndef TERMINAL_RENDER_TARGET_HPP
+#define TERMINAL_RENDER_TARGET_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "render-target.hpp"
+#include "software-render-target.hpp"
+
+namespace render_target {
+
+/**
+ * @brief Draws into an ANSI terminal with 24-bit colours.
+ *
+ * Every character cell covers cellSize pixels and shows two square dots
+ * as an upper half block, text is written as plain characters. display()
+ * compares the frame with the last one written and emits escape sequences
+ * only for the cells that changed.
+ *
+ * out must outlive the target, the destructor restores the terminal
+ * attributes and the cursor.
+ */
+class TerminalRenderTarget final : public IRenderTarget {
+public:
+    TerminalRenderTarget(std::size_t columns, std::size_t rows,
+                         sf::Vector2f cellSize, std::ostream& out);
+    ~TerminalRenderTarget() override;
+
+    TerminalRenderTarget(const TerminalRenderTarget&) = delete;
+    TerminalRenderTarget& operator=(const TerminalRenderTarget&) = delete;
+
+public:
+    sf::Vector2u size() const override;
+    void clear(sf::Color color) override;
+    void fillRect(sf::FloatRect rect, sf::Color color) override;
+    void drawTriangles(
+        std::span<const sf::Vertex> vertices, sf::Vector2f offset) override;
+    void drawText(const TextRun& text) override;
+    void display() override;
+
+    // always nullptr, retained layers draw directly
+    std::unique_ptr<IRenderLayer> createLayer(sf::Vector2u size) override;
+    // does nothing, there are no layers of this target to draw
+    void drawLayer(IRenderLayer& layer, sf::Vector2f position) override;
+
+public:
+    // the next display() repaints every cell, e.g. after the terminal was resized
+    void invalidateScreen();
+    std::size_t columns() const;
+    std::size_t rows() const;
+    // what the last display() wrote
+    std::size_t lastFrameBytes() const;
+    std::size_t lastFrameCells() const;
+
+private:
+    struct Cell {
+        // 0 is the half block, fg is its upper and bg its lower dot
+        char ch = 0;
+        sf::Color fg;
+        sf::Color bg;
+
+        bool operator==(const Cell&) const = default;
+    };
+
+    // SGR colours the terminal currently has, unknown until set
+    struct Pen {
+        std::optional<sf::Color> fg;
+        std::optional<sf::Color> bg;
+    };
+
+    void composeCells_();
+    void moveCursor_(std::size_t row, std::size_t col);
+    static void putCell_(std::string& out, Pen& pen, const Cell& cell);
+
+private:
+    std::size_t columns_;
+    std::size_t rows_;
+    sf::Vector2f cellSize_;
+    std::ostream& out_;
+
+    // two dots per cell vertically
+    SoftwareRenderTarget dots_;
+    std::vector<sf::Vertex> scratchVertices_;
+    std::vector<char> textChars_;
+    std::vector<sf::Color> textColors_;
+
+    std::vector<Cell> cells_;
+    std::vector<Cell> shadow_;
+    bool isScreenValid_ = false;
+
+    std::string frame_;
+    std::string scratchFrame_;
+    Pen pen_;
+    std::size_t cursorRow_ = 0;
+    std::size_t cursorCol_ = 0;
+    bool isCursorKnown_ = false;
+
+    std::size_t lastFrameBytes_ = 0;
+    std::size_t lastFrameCells_ = 0;
+};
+
+} // namespace render_target
+
+#endif // TERMINAL_RENDER_TARGET_HPP
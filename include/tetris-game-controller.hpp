@@ -2,40 +2,123 @@
 #define TETRIS_GAME_CONTROLLER_HPP
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 
-#include "lock-based-queue.hpp"
+#include "lock-free-queue.hpp"
 #include "observer-n-subject.hpp"
+#include "perf-stats.hpp"
 #include "player-input.hpp"
+#include "render-target.hpp"
 #include "tetris-game-model.hpp"
 #include "view.hpp"
 
 namespace tetris_game_controller {
 
+enum class LoopMode : std::uint8_t {
+    // yield between empty polls, lowest latency, burns a core
+    SPIN = 0,
+    // sleep on the event queue, wake up at least every inputPollPeriod
+    BLOCKING,
+};
+
+/**
+ * @brief Cost of the controller loop: how often it woke up and how much 
+ * CPU time its thread has used.
+ */
+struct LoopStats {
+    std::uint64_t wakeUps = 0;
+    std::uint64_t eventsHandled = 0;
+    // input lost to a full event queue
+    std::uint64_t eventsDropped = 0;
+    // of the loop's thread alone, 0 where the platform has no per thread
+    // CPU clock
+    std::chrono::nanoseconds cpuTime {0};
+};
+
+/**
+ * @brief What became of the redraws the model asked for and how long its
+ * snapshots took to reach the screen.
+ */
+struct FrameStats {
+    std::uint64_t redrawRequests = 0;
+    std::uint64_t framesPresented = 0;
+    // requests that came while a frame was pending or being drawn and got
+    // no frame of their own
+    std::uint64_t framesCoalesced = 0;
+    // snapshots replaced by a newer one before they were drawn
+    std::uint64_t framesDropped = 0;
+    // from publishing a snapshot to presenting it
+    std::chrono::nanoseconds lastLatency {0};
+    std::chrono::nanoseconds maxLatency {0};
+    std::chrono::nanoseconds totalLatency {0};
+
+    std::chrono::nanoseconds meanLatency() const;
+};
+
 class TetrisGameController : public observer_n_subject::IObserver,  
                              public std::enable_shared_from_this<TetrisGameController> {
 public:
     TetrisGameController(
         std::shared_ptr<tetris_game_model::TetrisGameModel> gameModel,
         std::shared_ptr<player_input::IPlayerInput> playerInput,
-        std::shared_ptr<sf::RenderWindow> window,
+        std::shared_ptr<render_target::IRenderTarget> renderTarget,
         std::shared_ptr<view::IDrawableComposite> compositeView);
+    ~TetrisGameController() override;
 
     void registerAsObserver();
+    // the view is drawn on a thread of its own while the game loop runs
     void runModel(std::mutex& modelMut, std::atomic_bool& isGameRun, std::atomic_bool& isGamePause);
     std::shared_ptr<TetrisGameController> getThis();
+
+    // takes effect when runModel() starts
+    void setLoopMode(
+        LoopMode mode, 
+        std::chrono::milliseconds inputPollPeriod = std::chrono::milliseconds(10));
+    LoopMode loopMode() const;
+    // safe to call from any thread
+    LoopStats loopStats() const;
+
+    // at most fps frames per second, 0 draws every snapshot it gets to;
+    // takes effect when runModel() starts
+    void setFrameRateLimit(unsigned fps);
+    // safe to call from any thread
+    FrameStats frameStats() const;
+
+    // samples what the perf HUD shows, nullptr stops sampling;
+    // takes effect when runModel() starts
+    void setPerfStats(std::shared_ptr<perf_stats::PerfStats> stats);
     
 private:
     void gameLoop_(std::mutex& modelMut, std::atomic_bool& isGameRun, std::atomic_bool& isGamePause);
+    void spinGameLoop_(std::mutex& modelMut, std::atomic_bool& isGameRun, std::atomic_bool& isGamePause);
+    void blockingGameLoop_(std::mutex& modelMut, std::atomic_bool& isGameRun, std::atomic_bool& isGamePause);
+    bool isGameRunning_(std::atomic_bool& isGameRun);
+    void countWakeUp_();
     void handleEvent_(
         std::mutex& modelMut, std::atomic_bool& isGameRun, 
         std::atomic_bool& isGamePause,  observer_n_subject::EventType event);
-    void updateScoreView_();
-    void updateFieldView_();
+    template <typename F>
+    void withModel_(std::mutex& modelMut, F&& func);
+    void markInput_();
+    void requestFrame_();
+    void waitFrameRequest_(std::uint64_t seenRequests);
+    void startRenderThread_();
+    void stopRenderThread_();
+    void renderLoop_();
+    bool presentFrame_();
+    void countCoalesced_(std::uint64_t requests, bool isPresented);
+    void updateScoreView_(int score);
+    void updateFieldView_(
+        const tetris_game_model::FieldSnapshot& snapshot, std::uint64_t paintedSequence);
     void redrawWindowNDisplay_();
     sf::Color tetrominoBlockColor_(tetris_game_model::BlockType block) const;
 
@@ -47,9 +130,46 @@ public:
 private:
     std::shared_ptr<tetris_game_model::TetrisGameModel> gameModel_;
     std::shared_ptr<player_input::IPlayerInput> playerInput_;
-    lock_based_queue::LockBasedQueue<observer_n_subject::EventType> eventQueue_;
-    std::shared_ptr<sf::RenderWindow> window_;
+    lock_free_queue::LockFreeQueue<observer_n_subject::EventType, 1024> eventQueue_;
+    std::shared_ptr<render_target::IRenderTarget> renderTarget_;
     std::shared_ptr<view::IDrawableComposite> compositeView_;
+    view::Handle<view::DrawableGridCanvas> fieldView_;
+    view::Handle<view::DrawableText> scoreView_;
+
+    LoopMode loopMode_ = LoopMode::BLOCKING;
+    std::chrono::milliseconds inputPollPeriod_ {10};
+    std::atomic<std::uint64_t> wakeUps_ = 0;
+    std::atomic<std::uint64_t> eventsHandled_ = 0;
+    std::atomic<std::uint64_t> eventsDropped_ = 0;
+    // GAME_FINISH may be raised on the loop's own thread, so it is not
+    // left to a queue that could be full
+    std::atomic_bool isGameFinished_ = false;
+    std::atomic<std::int64_t> loopCpuTimeNs_ = 0;
+    std::chrono::nanoseconds loopStartCpuTime_ {0};
+
+    // the view, its target and everything below belong to the render thread
+    std::thread renderThread_;
+    // bumped by every redraw request and by stopping, the render thread waits on it
+    std::atomic<std::uint64_t> frameRequests_ = 0;
+    std::atomic_bool isRenderStopped_ = false;
+    std::atomic_bool isRenderSleeping_ = false;
+    std::mutex renderMut_;
+    std::condition_variable renderCv_;
+    std::chrono::steady_clock::duration minFramePeriod_ {0};
+    std::uint64_t paintedSequence_ = 0;
+    int paintedScore_ = 0;
+
+    std::atomic<std::uint64_t> redrawRequests_ = 0;
+    std::atomic<std::uint64_t> framesPresented_ = 0;
+    std::atomic<std::uint64_t> framesCoalesced_ = 0;
+    std::atomic<std::uint64_t> framesDropped_ = 0;
+    std::atomic<std::int64_t> lastLatencyNs_ = 0;
+    std::atomic<std::int64_t> maxLatencyNs_ = 0;
+    std::atomic<std::int64_t> totalLatencyNs_ = 0;
+
+    std::shared_ptr<perf_stats::PerfStats> perfStats_;
+    // arrival of the oldest input no frame has answered yet, 0 if none
+    std::atomic<std::int64_t> pendingInputNs_ = 0;
 }; 
 
 } // namespace tetris_game_controller
@@ -1,11 +1,15 @@
 #ifndef TETRIS_GAME_MODEL_HPP
 #define TETRIS_GAME_MODEL_HPP
 
+#include <bit>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 #include "observer-n-subject.hpp"
+#include "tetromino.hpp"
 
 namespace tetris_game_model {
 
@@ -21,6 +25,89 @@ enum class BlockType: std::uint8_t {
     GHOST,
 };
 
+/**
+ * @brief Cells of the field changed since the last reset: a bit per cell 
+ * plus the rows deleted by lines.
+ */
+class FieldChangeSet {
+public:
+    FieldChangeSet(std::size_t fieldWidth, std::size_t fieldHeight);
+
+public:
+    void markDirty(std::size_t x, std::size_t y);
+    // rows [fromRow, toRow)
+    void markRowsDirty(std::size_t fromRow, std::size_t toRow);
+    void markAllDirty();
+    void addDeletedRows(const std::vector<std::size_t>& rows);
+    // O(changed rows)
+    void reset();
+
+    bool empty() const;
+    // func(x, y) for every changed cell, row by row
+    template <typename F>
+    void forEachDirtyCell(F&& func) const;
+    // rows with a changed cell, in the order they were first marked
+    const std::vector<std::size_t>& dirtyRows() const;
+    // rows (ascending, as they were before deletion) deleted since the last reset
+    const std::vector<std::size_t>& deletedRows() const;
+
+private:
+    using word_t = std::uint64_t;
+    static constexpr std::size_t WORD_BITS = sizeof(word_t) * 8;
+
+    std::size_t fieldWidth_;
+    std::size_t fieldHeight_;
+    std::vector<word_t> dirty_;
+    // a byte per row, set for the rows in dirtyRows_
+    std::vector<std::uint8_t> isRowDirty_;
+    std::vector<std::size_t> dirtyRows_;
+    std::vector<std::size_t> deletedRows_;
+};
+
+template <typename F>
+void FieldChangeSet::forEachDirtyCell(F&& func) const {
+    if (empty()) return;
+    for (std::size_t w = 0; w < dirty_.size(); ++w) {
+        for (auto word = dirty_[w]; word != 0; word &= word - 1) {
+            auto cell = w * WORD_BITS + std::countr_zero(word);
+            func(cell % fieldWidth_, cell / fieldWidth_);
+        }
+    }
+}
+
+/**
+ * @brief The field and the score as of one update, a byte per cell row 
+ * by row.
+ */
+struct FieldSnapshot {
+    std::size_t width = 0;
+    std::size_t height = 0;
+    std::vector<BlockType> cells;
+    int score = 0;
+    // 1 for the first snapshot, one more for every later one
+    std::uint64_t sequence = 0;
+    std::chrono::steady_clock::time_point publishedAt;
+    // this one was made from snapshot baseSequence, 0 from nothing, by
+    // copying over these rows; a reader that shows baseSequence or a later
+    // one only has to repaint them
+    std::uint64_t baseSequence = 0;
+    std::vector<std::size_t> dirtyRows;
+
+    BlockType at(std::size_t x, std::size_t y) const {
+        return cells[y * width + x];
+    }
+};
+
+/**
+ * @brief What publishing the snapshots has cost the updating thread.
+ */
+struct SnapshotStats {
+    std::uint64_t published = 0;
+    std::chrono::nanoseconds lastPublishCost {0};
+    std::chrono::nanoseconds maxPublishCost {0};
+    std::chrono::nanoseconds totalPublishCost {0};
+};
+
 class TetrisGameModelImpl__;
 class TetrisGameModelImplDeleter {
 public:
@@ -30,6 +117,8 @@ public:
 class TetrisGameModel final : public observer_n_subject::ISubject {
 public:
     TetrisGameModel(std::size_t fieldWidth = 21, std::size_t fieldHeight = 41);
+    // the same tetrominoes in the same order for the same seed
+    TetrisGameModel(std::size_t fieldWidth, std::size_t fieldHeight, std::uint64_t seed);
 
     using field_t = std::vector<std::vector<BlockType>>;
     
@@ -48,10 +137,38 @@ public:
     int score() const;
     std::size_t fieldWidth() const; 
     std::size_t fieldHeight() const;
+    bool isGameFinished() const;
+    // the falling one, or the last one locked once the game is finished
+    const tetrominoes::Tetromino& currentTetromino() const;
+    // since the game started
+    std::uint64_t piecesLocked() const;
+    std::uint64_t linesCleared() const;
+    // zobrist::blockKey of every locked block xor-ed, equal to the hash of
+    // placement_search::lockedBoard()
+    std::uint64_t lockedFieldHash() const;
+    // no locked blocks above this row, fieldHeight() on an empty field
+    std::size_t stackTop() const;
+    // rows (ascending) deleted by the last locked tetromino
+    const std::vector<std::size_t>& deletedRows() const;
+    // cells changed since the last published snapshot, empty while
+    // publishing is off
+    const FieldChangeSet& changeSet() const;
+    // off by default, nothing is copied for a reader that is not there;
+    // turning it on publishes the current state at once
+    void setSnapshotPublishing(bool isPublishing);
+    bool isSnapshotPublishing() const;
+    // the newest snapshot published before GAME_FIELD_UPDATE or 
+    // GAME_SCORE_UPDATE, an empty one while publishing is off;
+    // lock-free, for one reader thread at a time
+    const FieldSnapshot& latestSnapshot();
+    // safe to call from any thread
+    SnapshotStats snapshotStats() const;
 
     bool rotateRightTetromino();     
     bool moveLeftTetromino();
     bool moveRightTetromino();
+    // drops and locks the tetromino at once
+    bool hardDropTetromino();
 
 private:
     std::unique_ptr<TetrisGameModelImpl__, TetrisGameModelImplDeleter> impl_;
@@ -1,7 +1,9 @@
 #ifndef TETROMINO_MOVEMENT_HPP
 #define TETROMINO_MOVEMENT_HPP
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -22,11 +24,26 @@ public:
     virtual bool moveLeft() = 0;
     virtual bool moveRight() = 0;
     virtual bool setTetromino(tetrominoes::Tetromino tetromino) = 0;
+    // moves the tetromino onto its ghost
+    virtual bool hardDrop() = 0;
+
+    // the tetromino can't move down anymore and becomes a part of the field
+    virtual void lockTetromino() = 0;
+    // rows (ascending) were deleted from the field and the rows above lowered
+    virtual void linesDeleted(const std::vector<std::size_t>& rows) = 0;
+
+    const tetrominoes::Tetromino& tetromino() const { return curTetromino_; }
+    // cells written to the field are marked in it, nullptr stops marking
+    void setChangeSet(std::shared_ptr<tetris_game_model::FieldChangeSet> changeSet);
 
     virtual ~TetrominoMovement() { }
 
+protected:
+    void writeBlock_(std::size_t x, std::size_t y, tetris_game_model::BlockType block);
+
 protected:
     std::shared_ptr<std::vector<std::vector<tetris_game_model::BlockType>>> field_;
+    std::shared_ptr<tetris_game_model::FieldChangeSet> changeSet_;
     tetrominoes::Tetromino curTetromino_;
 };
 
@@ -40,6 +57,9 @@ public:
     bool moveLeft() override;
     bool moveRight() override;
     bool setTetromino(tetrominoes::Tetromino tetromino) override;
+    bool hardDrop() override;
+    void lockTetromino() override;
+    void linesDeleted(const std::vector<std::size_t>& rows) override;
 
 private:
     bool canMoveDownTetromino_(const tetrominoes::Tetromino& tetromino) const;
@@ -70,6 +90,71 @@ private:
 
 };
 
+/**
+ * @brief Movement with ghost tetromino, collisions are tested against
+ * per-row occupancy bitmasks instead of the field itself.
+ * 
+ * Bit (x + 1) of a row is the block at column x, bit 0 and bit (width + 1) 
+ * are wall sentinels, rows_[height] is a solid floor. Only locked blocks 
+ * are kept in the masks, so a placement test is an AND per piece row.
+ * 
+ * heights_[x] is the topmost locked row of column x (field height if the 
+ * column is empty), the ghost lands where the first column of the piece 
+ * bottom profile meets it.
+ */
+class BitboardTetrominoMovement final : public TetrominoMovement {
+public:
+    using row_t = std::uint64_t;
+    // two bits of a row are taken by the walls
+    static constexpr std::size_t MAX_FIELD_WIDTH = sizeof(row_t) * 8 - 2;
+
+public:
+    void setField(
+        std::shared_ptr<std::vector<std::vector<tetris_game_model::BlockType>>> field
+    ) override;
+    bool rotateRight() override;
+    bool moveDown() override;
+    bool moveLeft() override;
+    bool moveRight() override;
+    bool setTetromino(tetrominoes::Tetromino tetromino) override;
+    bool hardDrop() override;
+    void lockTetromino() override;
+    void linesDeleted(const std::vector<std::size_t>& rows) override;
+
+private:
+    struct PieceMask {
+        int top = 0;
+        int height = 0;
+        std::array<row_t, 4> rows {};
+    };
+
+    PieceMask makeMask_(const tetrominoes::Tetromino& tetromino) const;
+    bool fits_(const PieceMask& mask, int dx, int dy) const;
+    int dropDistance_(const PieceMask& mask) const;
+    int ghostDropDistance_() const;
+
+    void rebuildRows_();
+    int columnHeight_(std::size_t x, std::size_t fromY) const;
+
+    void setCurTetrominoOnField_();    
+    void deleteCurTetrominoOnField_();
+
+    // valid only while curTetromino_ is where the ghost was computed for
+    void deleteCurTetrominoGhostOnField_();
+    void updateTetrominoGhost_();
+
+    std::size_t fieldWidth_() const; 
+    std::size_t fieldHeight_() const;
+
+private:
+    std::vector<row_t> rows_;
+    std::vector<int> heights_;
+    row_t emptyRow_ = 0;
+    PieceMask curMask_;
+    int ghostDy_ = 0;
+};
+
+
 } // namespace tetromino_movement 
 
 
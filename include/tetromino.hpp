@@ -2,69 +2,307 @@
 #define SRC_INCLUDE_TETROMINO_HPP
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
-#include <climits>
-#include <initializer_list>
-#include <utility>
-#include <vector>
+#include <span>
+#include <type_traits>
 #include <cstdint>
 
 namespace tetrominoes {
 
-using Block = std::pair<int, int>;
+// packed (x, y), named like the std::pair it replaces
+struct Block {
+    constexpr Block(int x = 0, int y = 0) noexcept :
+        first(static_cast<std::int16_t>(x))
+        , second(static_cast<std::int16_t>(y))
+    {}
+
+    friend constexpr bool operator==(const Block&, const Block&) = default;
+
+    std::int16_t first;
+    std::int16_t second;
+};
 
 enum class TetrominoType : std::uint8_t;
 enum class TetrominoType : std::uint8_t {
     O = 0, I, S, Z, L, J, T
 };
 
+inline constexpr std::size_t TYPES_COUNT = 7;
+inline constexpr std::size_t ROTATIONS_COUNT = 4;
+inline constexpr std::size_t BLOCKS_COUNT = 4;
+
+/**
+ * @brief One orientation of a tetromino, relative to the top-left corner
+ * of its bounding box.
+ *
+ * bottom[x] is the lowest block offset in column x of the box.
+ */
+struct ShapeInfo {
+    std::array<Block, BLOCKS_COUNT> blocks;
+    std::int8_t width;
+    std::int8_t height;
+    std::array<std::int8_t, BLOCKS_COUNT> bottom;
+};
+
+constexpr const ShapeInfo& shapeInfo(TetrominoType type, std::size_t rotation) noexcept;
+
 class Tetromino {
 public:
-    Tetromino(std::initializer_list<Block> shape, TetrominoType type); 
+    constexpr explicit Tetromino(TetrominoType type, std::size_t rotation = 0) noexcept;
     Tetromino() = default;
 
 public:
-    const std::vector<Block>& shape() const noexcept;
-    TetrominoType type() const;
+    constexpr std::span<const Block> shape() const noexcept;
+    constexpr TetrominoType type() const noexcept;
+    constexpr std::size_t rotation() const noexcept;
+    constexpr const ShapeInfo& shapeInfo() const noexcept;
 
-    int greatestSide() const;
-    int lowestPointOnY() const;
-    int highestPointOnY() const;
-    int leftmostPointOnX() const;
-    int rightmostPointOnX() const;
+    constexpr int greatestSide() const noexcept;
+    constexpr int lowestPointOnY() const noexcept;
+    constexpr int highestPointOnY() const noexcept;
+    constexpr int leftmostPointOnX() const noexcept;
+    constexpr int rightmostPointOnX() const noexcept;
 
-    void moveDownOneSquare() noexcept;
-    void moveLeftOneSquare() noexcept;
-    void moveRightOneSquare() noexcept;
+    constexpr void moveDownOneSquare() noexcept;
+    constexpr void moveLeftOneSquare() noexcept;
+    constexpr void moveRightOneSquare() noexcept;
+    constexpr void moveDownSquares(int count) noexcept;
 
-    void rotateRigth() noexcept;
+    // the top-left corner of the bounding box stays in place
+    constexpr void rotateRigth() noexcept;
 
-    bool containsBlock(Block block) const noexcept;
+    constexpr bool containsBlock(Block block) const noexcept;
 
 private:
-    void swapShapeAxis_() noexcept;
-    void reflectShape_() noexcept;
-    void setShapeBoundaries_() noexcept;
+    constexpr void placeShape_() noexcept;
 
 private:
-    std::vector<Block> shape_ ;
-    int greatestSide_;
-    int lowestPointOnY_;
-    int leftmostPointOnX_;
-    int rightmostPointOnX_;
-    int highestPointOnY_;
+    std::array<Block, BLOCKS_COUNT> shape_;
+    std::int16_t leftmostPointOnX_;
+    std::int16_t highestPointOnY_;
+    std::uint8_t rotation_;
     TetrominoType type_;
 };
 
-Tetromino create_O_shape();
-Tetromino create_I_shape();
-Tetromino create_S_shape();
-Tetromino create_Z_shape();
-Tetromino create_L_shape();
-Tetromino create_J_shape();
-Tetromino create_T_shape();
+// copied on every rotation probe and ghost update, must stay memcpy-cheap
+static_assert(std::is_trivially_copyable_v<Tetromino>);
+
+constexpr Tetromino create_O_shape() noexcept;
+constexpr Tetromino create_I_shape() noexcept;
+constexpr Tetromino create_S_shape() noexcept;
+constexpr Tetromino create_Z_shape() noexcept;
+constexpr Tetromino create_L_shape() noexcept;
+constexpr Tetromino create_J_shape() noexcept;
+constexpr Tetromino create_T_shape() noexcept;
 Tetromino getRandomTetromino();
- 
+
+/**
+ * @brief Tetrominoes of uniformly random types, the same sequence for the 
+ * same seed with every compiler and standard library.
+ */
+class TetrominoGenerator {
+public:
+    explicit TetrominoGenerator(std::uint64_t seed) noexcept;
+
+public:
+    Tetromino next() noexcept;
+
+private:
+    std::uint64_t state_;
+};
+
+// ##################################################
+// shape tables
+namespace details {
+
+constexpr ShapeInfo makeShapeInfo(std::array<Block, BLOCKS_COUNT> blocks) noexcept {
+    ShapeInfo info { blocks, 0, 0, {-1, -1, -1, -1} };
+    for (const auto& b : blocks) {
+        info.width = std::max<std::int8_t>(info.width, b.first + 1);
+        info.height = std::max<std::int8_t>(info.height, b.second + 1);
+        info.bottom[b.first] = std::max<std::int8_t>(info.bottom[b.first], b.second);
+    }
+    return info;
+}
+
+// clockwise: swap the axes, then reflect over the vertical middle
+constexpr ShapeInfo rotateShapeInfo(const ShapeInfo& info) noexcept {
+    std::array<Block, BLOCKS_COUNT> blocks;
+    for (std::size_t i = 0; i < BLOCKS_COUNT; ++i) {
+        const auto& b = info.blocks[i];
+        blocks[i] = Block(info.height - 1 - b.second, b.first);
+    }
+    return makeShapeInfo(blocks);
+}
+
+using shape_table_t =
+    std::array<std::array<ShapeInfo, ROTATIONS_COUNT>, TYPES_COUNT>;
+
+constexpr shape_table_t makeShapeTable() noexcept {
+    // indexed by TetrominoType
+    constexpr std::array<std::array<Block, BLOCKS_COUNT>, TYPES_COUNT> spawnShapes {{
+        { { {0, 0}, {0, 1}, {1, 0}, {1, 1} } },
+        { { {0, 0}, {1, 0}, {2, 0}, {3, 0} } },
+        { { {0, 1}, {0, 2}, {1, 0}, {1, 1} } },
+        { { {0, 0}, {0, 1}, {1, 1}, {1, 2} } },
+        { { {0, 0}, {1, 0}, {2, 0}, {2, 1} } },
+        { { {0, 1}, {1, 1}, {2, 0}, {2, 1} } },
+        { { {0, 0}, {0, 1}, {0, 2}, {1, 1} } },
+    }};
+
+    shape_table_t table {};
+    for (std::size_t type = 0; type < TYPES_COUNT; ++type) {
+        table[type][0] = makeShapeInfo(spawnShapes[type]);
+        for (std::size_t r = 1; r < ROTATIONS_COUNT; ++r) {
+            table[type][r] = rotateShapeInfo(table[type][r - 1]);
+        }
+    }
+    return table;
+}
+
+inline constexpr shape_table_t SHAPE_TABLE = makeShapeTable();
+
+} // namespace details
+
+constexpr const ShapeInfo& shapeInfo(TetrominoType type, std::size_t rotation) noexcept {
+    return details::SHAPE_TABLE[static_cast<std::size_t>(type)][rotation % ROTATIONS_COUNT];
+}
+
+// ##################################################
+// Tetromino
+constexpr Tetromino::Tetromino(TetrominoType type, std::size_t rotation) noexcept :
+    shape_()
+    , leftmostPointOnX_(0)
+    , highestPointOnY_(0)
+    , rotation_(static_cast<std::uint8_t>(rotation % ROTATIONS_COUNT))
+    , type_(type)
+{
+    placeShape_();
+}
+
+constexpr std::span<const Block> Tetromino::shape() const noexcept {
+    return shape_;
+}
+
+constexpr TetrominoType Tetromino::type() const noexcept {
+    return type_;
+}
+
+constexpr std::size_t Tetromino::rotation() const noexcept {
+    return rotation_;
+}
+
+constexpr const ShapeInfo& Tetromino::shapeInfo() const noexcept {
+    return tetrominoes::shapeInfo(type_, rotation_);
+}
+
+constexpr int Tetromino::greatestSide() const noexcept {
+    const auto& info = shapeInfo();
+    return std::max(info.width, info.height);
+}
+
+constexpr int Tetromino::lowestPointOnY() const noexcept {
+    return highestPointOnY_ + shapeInfo().height - 1;
+}
+
+constexpr int Tetromino::highestPointOnY() const noexcept {
+    return highestPointOnY_;
+}
+
+constexpr int Tetromino::leftmostPointOnX() const noexcept {
+    return leftmostPointOnX_;
+}
+
+constexpr int Tetromino::rightmostPointOnX() const noexcept {
+    return leftmostPointOnX_ + shapeInfo().width - 1;
+}
+
+constexpr void Tetromino::moveDownOneSquare() noexcept {
+    for (auto& p : shape_) {
+        ++p.second;
+    }
+    ++highestPointOnY_;
+}
+
+constexpr void Tetromino::moveLeftOneSquare() noexcept {
+    for (auto& p : shape_) {
+        --p.first;
+    }
+    --leftmostPointOnX_;
+}
+
+constexpr void Tetromino::moveRightOneSquare() noexcept {
+    for (auto& p : shape_) {
+        ++p.first;
+    }
+    ++leftmostPointOnX_;
+}
+
+constexpr void Tetromino::moveDownSquares(int count) noexcept {
+    for (auto& p : shape_) {
+        p.second += count;
+    }
+    highestPointOnY_ += count;
+}
+
+constexpr void Tetromino::rotateRigth() noexcept {
+    rotation_ = (rotation_ + 1) % ROTATIONS_COUNT;
+    placeShape_();
+}
+
+constexpr bool Tetromino::containsBlock(Block block) const noexcept {
+    for (const auto& p : shape_) {
+        if (block == p) {
+            return true;
+        }
+    }
+    return false;
+}
+
+constexpr void Tetromino::placeShape_() noexcept {
+    const auto& blocks = shapeInfo().blocks;
+    for (std::size_t i = 0; i < BLOCKS_COUNT; ++i) {
+        shape_[i] = Block(
+            leftmostPointOnX_ + blocks[i].first,
+            highestPointOnY_ + blocks[i].second);
+    }
+}
+
+// ##################################################
+// factories
+constexpr Tetromino create_O_shape() noexcept {
+    return Tetromino(TetrominoType::O);
+}
+
+constexpr Tetromino create_I_shape() noexcept {
+    return Tetromino(TetrominoType::I);
+}
+
+constexpr Tetromino create_S_shape() noexcept {
+    return Tetromino(TetrominoType::S);
+}
+
+constexpr Tetromino create_Z_shape() noexcept {
+    return Tetromino(TetrominoType::Z);
+}
+
+constexpr Tetromino create_L_shape() noexcept {
+    return Tetromino(TetrominoType::L);
+}
+
+constexpr Tetromino create_J_shape() noexcept {
+    return Tetromino(TetrominoType::J);
+}
+
+constexpr Tetromino create_T_shape() noexcept {
+    return Tetromino(TetrominoType::T);
+}
+
+static_assert(create_I_shape().rightmostPointOnX() == 3);
+static_assert(shapeInfo(TetrominoType::I, 1).height == 4);
+static_assert(shapeInfo(TetrominoType::T, 2).blocks[3] == Block(0, 1));
+
 } // namespace tetrominoes
 
-#endif // SRC_INCLUDE_TETROMINO_HPP
\ No newline at end of file
+#endif // SRC_INCLUDE_TETROMINO_HPP
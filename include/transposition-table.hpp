@@ -0,0 +1,53 @@
+#ifndef TRANSPOSITION_TABLE_HPP
+#define TRANSPOSITION_TABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace transposition_table {
+
+/**
+ * @brief A fixed number of values cached by 64-bit keys, shared by
+ * threads without locks.
+ *
+ * A key has one slot, picked by its low bits, and a store replaces what
+ * was there. A slot is two words, the key xor-ed with the value and the
+ * value; a probe takes the value only if the words xor back to its key,
+ * so a slot torn by racing stores reads as a miss instead of a wrong
+ * value.
+ */
+class TranspositionTable {
+public:
+    // rounded up to a power of two
+    explicit TranspositionTable(std::size_t entries);
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+public:
+    // safe to call from any thread
+    std::optional<double> probe(std::uint64_t key) const;
+    void store(std::uint64_t key, double value);
+    // not while other threads use the table
+    void clear();
+    std::size_t size() const;
+
+private:
+    struct Entry {
+        std::atomic<std::uint64_t> check = 0;
+        std::atomic<std::uint64_t> value = 0;
+    };
+
+    std::size_t slot_(std::uint64_t key) const;
+
+private:
+    std::vector<Entry> entries_;
+    std::uint64_t mask_;
+};
+
+} // namespace transposition_table
+
+#endif // TRANSPOSITION_TABLE_HPP
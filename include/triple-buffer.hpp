@@ -0,0 +1,83 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace triple_buffer {
+
+inline constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Hands the newest value from one writer to one reader, neither
+ * ever waits for the other.
+ *
+ * The writer fills its back buffer and publishes it by swapping it with
+ * the middle one, the reader takes the middle one in exchange for its
+ * front buffer when a newer one was published. Values the reader was too
+ * slow to take are overwritten. The writer may change threads as long as
+ * the hand-over is synchronised, e.g. by a mutex, the same for the reader.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    explicit TripleBuffer(const T& init) {
+        for (auto& slot : slots_) {
+            slot.value = init;
+        }
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+public:
+    // writer; holds whatever was published two or more times ago
+    T& back() {
+        return slots_[back_].value;
+    }
+
+    // 0, 1 or 2, which of the buffers back() is, for a writer that keeps
+    // something of its own per buffer
+    std::size_t backIndex() const {
+        return back_;
+    }
+
+    void publish() {
+        auto prev = middle_.exchange(back_ | FRESH_BIT, std::memory_order_acq_rel);
+        back_ = prev & INDEX_MASK;
+    }
+
+public:
+    // reader; true if a newer value became the front one
+    bool acquire() {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH_BIT)) return false;
+        auto prev = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = prev & INDEX_MASK;
+        return true;
+    }
+
+    const T& front() const {
+        return slots_[front_].value;
+    }
+
+private:
+    static constexpr std::uint8_t INDEX_MASK = 0b011;
+    static constexpr std::uint8_t FRESH_BIT = 0b100;
+
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        T value {};
+    };
+
+    std::array<Slot, 3> slots_;
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint8_t> middle_ {1};
+    alignas(CACHE_LINE_SIZE) std::uint8_t back_ = 0;
+    alignas(CACHE_LINE_SIZE) std::uint8_t front_ = 2;
+};
+
+} // namespace triple_buffer
+
+#endif // TRIPLE_BUFFER_HPP
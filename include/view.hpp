@@ -1,16 +1,25 @@
 #ifndef INCLUDE_VIEW_HPP
 #define INCLUDE_VIEW_HPP
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <map>
 #include <list>
+#include <optional>
+#include <span>
+#include <unordered_map>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 
+#include "perf-stats.hpp"
+#include "render-target.hpp"
 #include "tetromino.hpp"
 #include "tetris-game-model.hpp"
 
@@ -18,26 +27,87 @@ using namespace tetris_game_model;
 
 namespace view {
 
+class IDrawableComposite;
+
 /**
  * @brief 
  * 
  */
 class IDrawable {
 public:
-    virtual void draw(sf::RenderWindow& window, sf::Vector2f start) = 0;
+    virtual void draw(render_target::IRenderTarget& target, sf::Vector2f start) = 0;
     virtual std::pair<float, float> size() const = 0;
     virtual ~IDrawable() { }
+
+protected:
+    // tells the ancestors that this component has to be redrawn,
+    // and re-measured if isSizeChanged
+    void invalidate_(bool isSizeChanged);
+
+private:
+    friend class IDrawableComposite;
+    IDrawableComposite* parent_ = nullptr;
+};
+
+/**
+ * @brief Entry of the tree-wide component index. Outlives the component: 
+ * emptied on deleteComponent(), refilled if the name is added again.
+ */
+struct ComponentSlot {
+    std::shared_ptr<IDrawable> component;
+};
+
+/**
+ * @brief Typed reference to a named component, resolved once.
+ * 
+ * get() costs a pointer comparison unless the slot changed since the last 
+ * call; it returns nullptr while the name is not in the tree or names a 
+ * component of another type.
+ */
+template <typename T>
+class Handle {
+public:
+    Handle() = default;
+
+public:
+    T* get() const {
+        if (!slot_) return nullptr;
+        auto* comp = slot_->component.get();
+        if (comp != source_) {
+            source_ = comp;
+            cached_ = dynamic_cast<T*>(comp);
+        }
+        return cached_;
+    }
+
+    T* operator->() const { return get(); }
+    T& operator*() const { return *get(); }
+    explicit operator bool() const { return get() != nullptr; }
+
+private:
+    friend class IDrawableComposite;
+    explicit Handle(std::shared_ptr<ComponentSlot> slot) : 
+        slot_(std::move(slot))
+    {}
+
+private:
+    std::shared_ptr<ComponentSlot> slot_;
+    mutable IDrawable* source_ = nullptr;
+    mutable T* cached_ = nullptr;
 };
 
-// TODO: добавить поиск компонента по имени
 /**
  * @brief 
  * 
+ * Component names are unique across the whole tree: the root composite 
+ * keeps a flat index of every named component below it.
  */
 class IDrawableComposite : public IDrawable {
 public:
+    ~IDrawableComposite() override;
+
     // TODO: мб сделать исключение по размеру окна и рисуемому компоненту
-    void draw(sf::RenderWindow& window, sf::Vector2f start) = 0;
+    void draw(render_target::IRenderTarget& target, sf::Vector2f start) = 0;
     // TODO: сделать исключения (??) по размерам 
     virtual void addComponent(
         std::shared_ptr<IDrawable> comp, const std::string& name) = 0;
@@ -47,22 +117,53 @@ public:
 
     virtual void deleteComponent(const std::string& name) = 0;
 
+    // may be taken before the component is added
+    template <typename T>
+    Handle<T> handle(const std::string& name);
+
+    std::pair<float, float> size() const override;
+
+protected:
+    friend class IDrawable;
+    virtual std::pair<float, float> measure_() const = 0;
+    // a component in this subtree changed
+    virtual void onChildInvalidated_(bool isSizeChanged);
+
+private:
+    using index_t = 
+        std::unordered_map<std::string, std::shared_ptr<ComponentSlot>>;
+
+    IDrawableComposite* root_();
+    bool isInSubtree_(const IDrawable* comp) const;
+    std::shared_ptr<ComponentSlot>& slot_(const std::string& name);
+    // moves the subtree's names from its own index to the root's one
+    void mergeIndexIntoRoot_();
+    // empties the slots of comp's subtree and gives it its own index again
+    void unregisterSubtree_(IDrawable& comp);
+
 private:
     std::map<std::string, 
             std::list<std::shared_ptr<IDrawable>>::iterator
         > componentsMap_;
+    // only used while this composite is a root
+    index_t index_;
+    mutable std::optional<std::pair<float, float>> cachedSize_;
 protected:
     std::list<std::shared_ptr<IDrawable>> components_;
 };
 
+template <typename T>
+Handle<T> IDrawableComposite::handle(const std::string& name) {
+    return Handle<T>(slot_(name));
+}
+
 /**
  * @brief 
  * 
  */
 class DrawableStackLayout final : public IDrawableComposite {    
 public:
-    void draw(sf::RenderWindow& window, sf::Vector2f start) override;
-    std::pair<float, float> size() const override;
+    void draw(render_target::IRenderTarget& target, sf::Vector2f start) override;
 
 public:
     void addComponent(
@@ -73,6 +174,8 @@ public:
 
     void deleteComponent(const std::string& name) override;
 
+private:
+    std::pair<float, float> measure_() const override;
 };
 
 /**
@@ -84,8 +187,7 @@ public:
     DrawableNestedLayout(float widthOffset, float heightOffset);
 
 public:
-    void draw(sf::RenderWindow& window, sf::Vector2f start) override;
-    std::pair<float, float> size() const override;
+    void draw(render_target::IRenderTarget& target, sf::Vector2f start) override;
 
 public:
     void addComponent(
@@ -102,11 +204,49 @@ public:
     void setWidthOffset(float offset);
     void setHeightOffset(float offset);
 
+private:
+    std::pair<float, float> measure_() const override;
+
 private:
     float widthOffset_;
     float heightOffset_;
 };
 
+/**
+ * @brief Renders its only component into an off-screen texture and draws 
+ * the texture until something in the subtree is invalidated.
+ * 
+ * For static or rarely changing subtrees.
+ */
+class DrawableRetainedLayer final : public IDrawableComposite {
+public:
+    void draw(render_target::IRenderTarget& target, sf::Vector2f start) override;
+
+public:
+    void addComponent(
+        std::shared_ptr<IDrawable> comp, const std::string& name) override;
+
+    std::shared_ptr<IDrawable> getComponent(
+        const std::string& name) override;
+
+    void deleteComponent(const std::string& name) override;
+
+    // times the subtree was rendered into the layer
+    std::size_t renderCount() const;
+
+private:
+    std::pair<float, float> measure_() const override;
+    void onChildInvalidated_(bool isSizeChanged) override;
+
+private:
+    std::unique_ptr<render_target::IRenderLayer> layer_;
+    // the target the layer was created by
+    const render_target::IRenderTarget* layerOwner_ = nullptr;
+    sf::Vector2u layerSize_;
+    bool isDirty_ = true;
+    std::size_t renderCount_ = 0;
+};
+
 /**
  * @brief 
  * 
@@ -116,7 +256,7 @@ public:
     DrawableFrame(float width, float height, float thickness, sf::Color color);
 
 public:
-    void draw(sf::RenderWindow& window, sf::Vector2f start) override;
+    void draw(render_target::IRenderTarget& target, sf::Vector2f start) override;
     std::pair<float, float> size() const override;
 
     void setThickness(float thickness);
@@ -127,13 +267,16 @@ public:
 private:
     float thickness_;
     sf::Color color_;
-    sf::RectangleShape externalRect_;
-    sf::RectangleShape internalRect_;
+    sf::Color internalColor_ = sf::Color::White;
+    sf::Vector2f size_;
 };
 
 /**
  * @brief 
  * 
+ * Cells are stored as one palette index each, index 0 starts out as 
+ * sf::Color::Transparent. Vertex colours of changed rows are refreshed 
+ * from the palette when the canvas is drawn.
  */
 class DrawableGridCanvas final : public IDrawable {
 public:
@@ -145,29 +288,48 @@ public:
                        sf::Color gridColor = sf::Color::Black);
 
 public:
-    void draw(sf::RenderWindow& window, sf::Vector2f start) override;
+    void draw(render_target::IRenderTarget& target, sf::Vector2f start) override;
     std::pair<float, float> size() const override;
     
+    // overwrites the cell, sf::Color::Transparent leaves it unpainted;
+    // a colour not in the palette yet is appended to it
     void paintCell(std::pair<std::size_t, std::size_t> pos, sf::Color color);
+    void paintCell(std::pair<std::size_t, std::size_t> pos, std::uint8_t index);
+    // overwrites a whole row of palette indices, unchanged rows cost a compare
+    void paintRow(std::size_t y, std::span<const std::uint8_t> indices);
+    // a block type is its own palette index
+    void paintRow(std::size_t y, std::span<const tetris_game_model::BlockType> blocks);
+    std::uint8_t cellIndex(std::pair<std::size_t, std::size_t> pos) const;
     void clear();
+
+    // cells keep their indices, so a new palette recolours all of them
+    void setPalette(std::span<const sf::Color> palette);
+    std::span<const sf::Color> palette() const;
+
     sf::Color gridColor() const;
     void setGridColor(sf::Color color);
 
-private:
-    void drawCellAt_(std::size_t cellX, 
-                      std::size_t cellY,
-                      sf::Vector2f start,
-                      sf::RenderWindow& window,
-                      sf::Color blockColor);
-    void drawGrid_(sf::RenderWindow& window, sf::Vector2f start);
+public:
+    static constexpr std::size_t MAX_PALETTE_SIZE = 256;
 
 private:
-    struct cell_t {
-        std::pair<std::size_t, std::size_t> pos;
-        sf::Color color;
-    };
+    std::uint8_t colorIndex_(sf::Color color);
+    void markRowDirty_(std::size_t y);
+    void uploadColors_();
+    void buildCells_();
+    void buildGrid_();
+
 private:
-    std::vector<cell_t> cells_;
+    // one palette index per cell, row-major
+    std::vector<std::uint8_t> cells_;
+    std::vector<sf::Color> palette_;
+    // rows whose vertex colours lag behind cells_, refreshed on draw
+    std::vector<std::uint8_t> dirtyRows_;
+    bool hasDirtyRows_ = false;
+    // two triangles per cell, row-major, positions relative to the canvas
+    std::vector<sf::Vertex> cellVertices_;
+    // grid lines, rebuilt only when the grid colour changes
+    std::vector<sf::Vertex> gridVertices_;
     float gridThickness_;
     std::size_t widthInCells_;
     std::size_t heightInCells_;
@@ -178,9 +340,32 @@ private:
     sf::Color gridColor_;
 };
 
+/**
+ * @brief Fonts loaded once per process. A font keeps its glyph atlas, so 
+ * texts sharing a font also share rasterised glyphs.
+ */
+class FontCache {
+public:
+    static FontCache& instance();
+
+public:
+    // loads the font on first use, throws like sf::Font if it cannot
+    std::shared_ptr<const sf::Font> get(const std::string& path);
+    std::size_t size() const;
+
+private:
+    FontCache() = default;
+
+private:
+    mutable std::mutex mut_;
+    std::unordered_map<std::string, std::shared_ptr<const sf::Font>> fonts_;
+};
+
 /**
  * @brief 
  * 
+ * An empty font path selects the built-in bitmap font, which needs no 
+ * font file and renders on every target.
  */
 class DrawableText final : public IDrawable {
 public:
@@ -189,16 +374,55 @@ public:
                  sf::Vector2f startPos = {0, 0});
 
 public:
-    void draw(sf::RenderWindow& window, sf::Vector2f start) override;
+    void draw(render_target::IRenderTarget& target, sf::Vector2f start) override;
+    std::pair<float, float> size() const override;
+    // no re-layout if txt equals the current text
+    void setText(std::string_view txt);
+    const std::string& text() const;
+
+private:
+    void measure_();
+
+private:
+    std::shared_ptr<const sf::Font> font_;
+    std::string text_;
+    int characterSize_;
+    sf::Color color_;
+    sf::Vector2f startPos_;
+    // only with a font file
+    std::optional<sf::Text> sfTxt_;
+    // getLocalBounds() measures every glyph, so it is only called on change
+    sf::Vector2f boundsSize_;
+};
+
+/**
+ * @brief Rolling p50, p99 and max of the perf stats, one line each.
+ * 
+ * Drawn with the built-in bitmap font into fixed-width lines, so it never
+ * allocates and its size never changes. Shows whatever was recorded up 
+ * to the frame it is drawn in.
+ */
+class DrawablePerfHud final : public IDrawable {
+public:
+    DrawablePerfHud(std::shared_ptr<const perf_stats::PerfStats> stats,
+                    int characterSize, sf::Color color = sf::Color::Black, 
+                    sf::Vector2f startPos = {0, 0});
+
+public:
+    void draw(render_target::IRenderTarget& target, sf::Vector2f start) override;
     std::pair<float, float> size() const override;
-    void setText(const std::string& txt);
-    std::string text() const;
+
+public:
+    // header and one line per quantity
+    static constexpr std::size_t LINE_COUNT = 6;
+    static constexpr std::size_t LINE_LENGTH = 36;
 
 private:
-    sf::Font font_;
+    std::shared_ptr<const perf_stats::PerfStats> stats_;
     int characterSize_;
+    sf::Color color_;
     sf::Vector2f startPos_;
-    sf::Text sfTxt_;
+    std::array<char, LINE_LENGTH> line_ {};
 };
 
 } // namespace view
@@ -0,0 +1,110 @@
+#ifndef WEIGHT_TUNING_HPP
+#define WEIGHT_TUNING_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "lookahead-bot.hpp"
+#include "simulation.hpp"
+#include "task-pool.hpp"
+
+namespace weight_tuning {
+
+// the fields of lookahead_bot::Weights, in their order
+inline constexpr std::size_t WEIGHTS_COUNT = 7;
+using weight_vector_t = std::array<double, WEIGHTS_COUNT>;
+
+weight_vector_t toVector(const lookahead_bot::Weights& weights);
+lookahead_bot::Weights fromVector(const weight_vector_t& vector);
+// snake_case, for the CSV header
+const char* weightName(std::size_t i);
+
+struct GameSetup {
+    std::size_t width = 10;
+    std::size_t height = 20;
+    // a good bot rarely loses, 0 plays to the end anyway
+    std::uint64_t maxPieces = 500;
+    lookahead_bot::SearchOptions search {2, 8, 1 << 14};
+};
+
+// a LookaheadPolicy game on the default model, the same result for the
+// same weights and seed whatever the pool
+simulation::GameResult playGame(
+    task_pool::TaskPool& pool, const lookahead_bot::Weights& weights,
+    const GameSetup& setup, std::uint64_t seed);
+
+struct Fitness {
+    // of the model's ScoreStrategy, what candidates are ranked by
+    double meanScore = 0.0;
+    double meanLines = 0.0;
+    double meanPieces = 0.0;
+    // games lost before maxPieces
+    std::size_t gamesLost = 0;
+};
+
+struct TuningOptions {
+    std::size_t population = 32;
+    // the best candidates the next distribution is fitted to
+    std::size_t elites = 8;
+    // every candidate of a generation plays the same seeds
+    std::size_t gamesPerCandidate = 8;
+    std::uint64_t seed = 1;
+    double initialDeviation = 0.5;
+    // added to the variances every generation, so they do not collapse
+    // before the mean settles
+    double extraVariance = 0.01;
+    GameSetup setup;
+};
+
+struct Candidate {
+    std::size_t generation = 0;
+    std::size_t index = 0;
+    lookahead_bot::Weights weights;
+    Fitness fitness;
+};
+
+/**
+ * @brief The cross-entropy method over the weights: samples a generation
+ * of candidates from independent normal distributions, plays their games
+ * and fits the distributions to the elites.
+ *
+ * Every game of a generation is a task of the pool, so all the cores are
+ * busy until the generation's last game. Candidates are drawn from a
+ * generator seeded by the options, game seeds follow from the options
+ * and the generation, so a run is repeated exactly by the same options.
+ */
+class CrossEntropyTuner {
+public:
+    CrossEntropyTuner(
+        task_pool::TaskPool& pool, TuningOptions options, lookahead_bot::Weights initial = {});
+
+public:
+    // plays a generation, its candidates best first
+    std::span<const Candidate> step();
+    std::size_t generation() const;
+    // of the distributions the next generation is drawn from
+    lookahead_bot::Weights mean() const;
+    weight_vector_t deviation() const;
+
+private:
+    task_pool::TaskPool& pool_;
+    TuningOptions options_;
+    weight_vector_t mean_;
+    weight_vector_t deviation_;
+    std::mt19937_64 gen_;
+    std::size_t generation_ = 0;
+    std::vector<Candidate> candidates_;
+};
+
+// one row per candidate
+void writeCsvHeader(std::ostream& out);
+void writeCsvRow(std::ostream& out, const Candidate& candidate);
+
+} // namespace weight_tuning
+
+#endif // WEIGHT_TUNING_HPP
@@ -0,0 +1,41 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "tetromino.hpp"
+
+namespace zobrist {
+
+// the splitmix64 finalizer, a bijection that scatters nearby inputs
+constexpr std::uint64_t mix(std::uint64_t z) {
+    z += 0x9e3779b97f4a7c15;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+// a locked block at (x, y); computed rather than looked up in a table of
+// random keys, so no table bounds the size of a field
+constexpr std::uint64_t blockKey(std::size_t x, std::size_t y) {
+    return mix(static_cast<std::uint64_t>(y) << 32 | x);
+}
+
+// the blocks of row y, bit x of the mask is column x
+constexpr std::uint64_t rowKey(std::uint64_t blocks, std::size_t y) {
+    std::uint64_t key = 0;
+    for (; blocks; blocks &= blocks - 1) {
+        key ^= blockKey(std::countr_zero(blocks), y);
+    }
+    return key;
+}
+
+constexpr std::uint64_t tetrominoKey(tetrominoes::TetrominoType type) {
+    return mix(~static_cast<std::uint64_t>(type));
+}
+
+} // namespace zobrist
+
+#endif // ZOBRIST_HPP
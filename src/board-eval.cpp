@@ -0,0 +1,447 @@
+#include "../include/board-eval.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BOARD_EVAL_X86 1
+#include <immintrin.h>
+#endif
+
+using placement_search::Board;
+using placement_search::row_t;
+
+namespace board_eval {
+
+namespace {
+
+// bits of the per column well depth counters, enough for MAX_HEIGHT
+constexpr std::size_t WELL_BITS = 7;
+
+static_assert((std::size_t{1} << WELL_BITS) > BoardBatch::MAX_HEIGHT);
+
+// the scalar kernel only makes the planes it needs, so it can afford
+// counters as wide as the features it sums them into
+constexpr std::size_t SCALAR_WELL_BITS = 31;
+
+// masks of a row of the batch's width, walls as in Board
+struct RowMasks {
+    explicit RowMasks(row_t emptyRow) :
+        cells(~emptyRow)
+        , pairs(cells & (cells >> 1))
+        , transitions(cells | 1)
+    {}
+
+    // bit x + 1 for every column x
+    row_t cells;
+    // columns x with a column x + 1
+    row_t pairs;
+    // bits with a neighbour on their left, the left wall included
+    row_t transitions;
+};
+
+// rows above first are empty; every empty row has two transitions at the
+// walls and none with the empty row below it
+std::size_t startRow(std::size_t first) {
+    return first ? first - 1 : 0;
+}
+
+// All the kernels run the same per row steps on the bitmasks, top down:
+//   seen       the columns with a block in this row or above
+//   height     + popcount(seen), a column counts once per row under its top
+//   holes      + popcount(seen & ~blocks)
+//   bumpiness  + popcount(seen ^ seen of the column to the right)
+//   row tr.    + popcount(row ^ the row shifted by a column), walls included
+//   column tr. + popcount(row ^ the row below), the floor is all blocks
+//   wells      a counter per column, bit sliced over planes, counts the
+//              well cells in a row down to here; + sum of the counters
+Features scalarFeatures(
+    const row_t* rows, std::size_t stride, std::size_t height, std::size_t first,
+    const RowMasks& masks) {
+    Features f;
+    auto start = startRow(first);
+    f.rowTransitions = static_cast<std::int32_t>(2 * start);
+
+    row_t seen = 0;
+    std::array<row_t, SCALAR_WELL_BITS> planes {};
+    std::size_t activePlanes = 0;
+    for (auto y = start; y < height; ++y) {
+        auto row = rows[y * stride];
+        auto below = y + 1 < height ? rows[(y + 1) * stride] : ~row_t{0};
+        auto blocks = row & masks.cells;
+        seen |= blocks;
+        f.aggregateHeight += std::popcount(seen);
+        f.holes += std::popcount(seen & ~blocks);
+        f.bumpiness += std::popcount((seen ^ (seen >> 1)) & masks.pairs);
+        f.rowTransitions += std::popcount((row ^ (row >> 1)) & masks.transitions);
+        f.columnTransitions += std::popcount((row ^ below) & masks.cells);
+
+        auto well = ~row & (row << 1) & (row >> 1) & masks.cells;
+        auto carry = well;
+        for (std::size_t b = 0; b < activePlanes; ++b) {
+            auto next = planes[b] & carry;
+            planes[b] = (planes[b] ^ carry) & well;
+            carry = next;
+        }
+        // a counter outgrew the planes in use
+        if (carry && activePlanes < SCALAR_WELL_BITS) {
+            planes[activePlanes++] = carry;
+        }
+        for (std::size_t b = 0; b < activePlanes; ++b) {
+            f.wells += std::popcount(planes[b]) << b;
+        }
+    }
+    return f;
+}
+
+void evaluateScalar(const BoardBatch& batch, std::span<Features> out) {
+    RowMasks masks(batch.emptyRow());
+    auto groupRows = batch.height() * BoardBatch::LANES;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        auto group = i / BoardBatch::LANES;
+        out[i] = scalarFeatures(
+            batch.data() + group * groupRows + i % BoardBatch::LANES,
+            BoardBatch::LANES, batch.height(), batch.firstRow(group), masks);
+    }
+}
+
+#ifdef BOARD_EVAL_X86
+
+// ##################################################
+// SSE
+// a byte at a time through a nibble table, then summed per 64 bit lane
+__attribute__((target("ssse3")))
+inline __m128i popcountSse(__m128i v) {
+    const auto table = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const auto nibble = _mm_set1_epi8(0x0f);
+    auto lo = _mm_shuffle_epi8(table, _mm_and_si128(v, nibble));
+    auto hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+    return _mm_sad_epu8(_mm_add_epi8(lo, hi), _mm_setzero_si128());
+}
+
+// two lanes of a group
+__attribute__((target("ssse3")))
+void sseLanes(
+    const row_t* rows, std::size_t height, std::size_t first,
+    const RowMasks& masks, Features* out, std::size_t count) {
+    const auto cells = _mm_set1_epi64x(static_cast<long long>(masks.cells));
+    const auto pairs = _mm_set1_epi64x(static_cast<long long>(masks.pairs));
+    const auto transitions = _mm_set1_epi64x(static_cast<long long>(masks.transitions));
+    const auto floor = _mm_set1_epi64x(-1);
+    auto start = startRow(first);
+
+    auto seen = _mm_setzero_si128();
+    auto aggregate = _mm_setzero_si128();
+    auto holes = _mm_setzero_si128();
+    auto bumpiness = _mm_setzero_si128();
+    auto rowTransitions = _mm_setzero_si128();
+    auto columnTransitions = _mm_setzero_si128();
+    __m128i planes[WELL_BITS];
+    __m128i wells[WELL_BITS];
+    std::size_t activePlanes = 0;
+
+    auto row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + start * BoardBatch::LANES));
+    for (auto y = start; y < height; ++y) {
+        auto below = y + 1 < height
+            ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + (y + 1) * BoardBatch::LANES))
+            : floor;
+        auto blocks = _mm_and_si128(row, cells);
+        seen = _mm_or_si128(seen, blocks);
+        aggregate = _mm_add_epi64(aggregate, popcountSse(seen));
+        holes = _mm_add_epi64(holes, popcountSse(_mm_andnot_si128(blocks, seen)));
+        bumpiness = _mm_add_epi64(bumpiness, popcountSse(
+            _mm_and_si128(_mm_xor_si128(seen, _mm_srli_epi64(seen, 1)), pairs)));
+        rowTransitions = _mm_add_epi64(rowTransitions, popcountSse(
+            _mm_and_si128(_mm_xor_si128(row, _mm_srli_epi64(row, 1)), transitions)));
+        columnTransitions = _mm_add_epi64(columnTransitions, popcountSse(
+            _mm_and_si128(_mm_xor_si128(row, below), cells)));
+
+        auto well = _mm_andnot_si128(row, _mm_and_si128(
+            _mm_and_si128(_mm_slli_epi64(row, 1), _mm_srli_epi64(row, 1)), cells));
+        auto carry = well;
+        for (std::size_t b = 0; b < activePlanes; ++b) {
+            auto next = _mm_and_si128(planes[b], carry);
+            planes[b] = _mm_and_si128(_mm_xor_si128(planes[b], carry), well);
+            carry = next;
+        }
+        auto isCarryZero = _mm_movemask_epi8(_mm_cmpeq_epi8(carry, _mm_setzero_si128())) == 0xffff;
+        if (activePlanes < WELL_BITS && !isCarryZero) {
+            planes[activePlanes] = carry;
+            wells[activePlanes] = _mm_setzero_si128();
+            ++activePlanes;
+        }
+        for (std::size_t b = 0; b < activePlanes; ++b) {
+            wells[b] = _mm_add_epi64(wells[b], popcountSse(planes[b]));
+        }
+        row = below;
+    }
+
+    alignas(16) std::array<std::array<std::uint64_t, 2>, 5 + WELL_BITS> sums;
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums[0].data()), aggregate);
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums[1].data()), holes);
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums[2].data()), bumpiness);
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums[3].data()), rowTransitions);
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums[4].data()), columnTransitions);
+    for (std::size_t b = 0; b < activePlanes; ++b) {
+        _mm_store_si128(reinterpret_cast<__m128i*>(sums[5 + b].data()), wells[b]);
+    }
+    for (std::size_t lane = 0; lane < count; ++lane) {
+        auto& f = out[lane];
+        f.aggregateHeight = static_cast<std::int32_t>(sums[0][lane]);
+        f.holes = static_cast<std::int32_t>(sums[1][lane]);
+        f.bumpiness = static_cast<std::int32_t>(sums[2][lane]);
+        f.rowTransitions = static_cast<std::int32_t>(sums[3][lane] + 2 * start);
+        f.columnTransitions = static_cast<std::int32_t>(sums[4][lane]);
+        f.wells = 0;
+        for (std::size_t b = 0; b < activePlanes; ++b) {
+            f.wells += static_cast<std::int32_t>(sums[5 + b][lane] << b);
+        }
+    }
+}
+
+void evaluateSse(const BoardBatch& batch, std::span<Features> out) {
+    RowMasks masks(batch.emptyRow());
+    auto groupRows = batch.height() * BoardBatch::LANES;
+    for (std::size_t i = 0; i < batch.size(); i += 2) {
+        auto group = i / BoardBatch::LANES;
+        sseLanes(
+            batch.data() + group * groupRows + i % BoardBatch::LANES,
+            batch.height(), batch.firstRow(group), masks,
+            &out[i], std::min<std::size_t>(2, batch.size() - i));
+    }
+}
+
+// ##################################################
+// AVX2
+__attribute__((target("avx2")))
+inline __m256i popcountAvx2(__m256i v) {
+    const auto table = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const auto nibble = _mm256_set1_epi8(0x0f);
+    auto lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, nibble));
+    auto hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+// the four lanes of a group
+__attribute__((target("avx2")))
+void avx2Lanes(
+    const row_t* rows, std::size_t height, std::size_t first,
+    const RowMasks& masks, Features* out, std::size_t count) {
+    const auto cells = _mm256_set1_epi64x(static_cast<long long>(masks.cells));
+    const auto pairs = _mm256_set1_epi64x(static_cast<long long>(masks.pairs));
+    const auto transitions = _mm256_set1_epi64x(static_cast<long long>(masks.transitions));
+    const auto floor = _mm256_set1_epi64x(-1);
+    auto start = startRow(first);
+
+    auto seen = _mm256_setzero_si256();
+    auto aggregate = _mm256_setzero_si256();
+    auto holes = _mm256_setzero_si256();
+    auto bumpiness = _mm256_setzero_si256();
+    auto rowTransitions = _mm256_setzero_si256();
+    auto columnTransitions = _mm256_setzero_si256();
+    __m256i planes[WELL_BITS];
+    __m256i wells[WELL_BITS];
+    std::size_t activePlanes = 0;
+
+    auto row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows + start * BoardBatch::LANES));
+    for (auto y = start; y < height; ++y) {
+        auto below = y + 1 < height
+            ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows + (y + 1) * BoardBatch::LANES))
+            : floor;
+        auto blocks = _mm256_and_si256(row, cells);
+        seen = _mm256_or_si256(seen, blocks);
+        aggregate = _mm256_add_epi64(aggregate, popcountAvx2(seen));
+        holes = _mm256_add_epi64(holes, popcountAvx2(_mm256_andnot_si256(blocks, seen)));
+        bumpiness = _mm256_add_epi64(bumpiness, popcountAvx2(
+            _mm256_and_si256(_mm256_xor_si256(seen, _mm256_srli_epi64(seen, 1)), pairs)));
+        rowTransitions = _mm256_add_epi64(rowTransitions, popcountAvx2(
+            _mm256_and_si256(_mm256_xor_si256(row, _mm256_srli_epi64(row, 1)), transitions)));
+        columnTransitions = _mm256_add_epi64(columnTransitions, popcountAvx2(
+            _mm256_and_si256(_mm256_xor_si256(row, below), cells)));
+
+        auto well = _mm256_andnot_si256(row, _mm256_and_si256(
+            _mm256_and_si256(_mm256_slli_epi64(row, 1), _mm256_srli_epi64(row, 1)), cells));
+        auto carry = well;
+        for (std::size_t b = 0; b < activePlanes; ++b) {
+            auto next = _mm256_and_si256(planes[b], carry);
+            planes[b] = _mm256_and_si256(_mm256_xor_si256(planes[b], carry), well);
+            carry = next;
+        }
+        if (activePlanes < WELL_BITS && !_mm256_testz_si256(carry, carry)) {
+            planes[activePlanes] = carry;
+            wells[activePlanes] = _mm256_setzero_si256();
+            ++activePlanes;
+        }
+        for (std::size_t b = 0; b < activePlanes; ++b) {
+            wells[b] = _mm256_add_epi64(wells[b], popcountAvx2(planes[b]));
+        }
+        row = below;
+    }
+
+    alignas(32) std::array<std::array<std::uint64_t, 4>, 5 + WELL_BITS> sums;
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums[0].data()), aggregate);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums[1].data()), holes);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums[2].data()), bumpiness);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums[3].data()), rowTransitions);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums[4].data()), columnTransitions);
+    for (std::size_t b = 0; b < activePlanes; ++b) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sums[5 + b].data()), wells[b]);
+    }
+    for (std::size_t lane = 0; lane < count; ++lane) {
+        auto& f = out[lane];
+        f.aggregateHeight = static_cast<std::int32_t>(sums[0][lane]);
+        f.holes = static_cast<std::int32_t>(sums[1][lane]);
+        f.bumpiness = static_cast<std::int32_t>(sums[2][lane]);
+        f.rowTransitions = static_cast<std::int32_t>(sums[3][lane] + 2 * start);
+        f.columnTransitions = static_cast<std::int32_t>(sums[4][lane]);
+        f.wells = 0;
+        for (std::size_t b = 0; b < activePlanes; ++b) {
+            f.wells += static_cast<std::int32_t>(sums[5 + b][lane] << b);
+        }
+    }
+}
+
+void evaluateAvx2(const BoardBatch& batch, std::span<Features> out) {
+    RowMasks masks(batch.emptyRow());
+    auto groupRows = batch.height() * BoardBatch::LANES;
+    for (std::size_t i = 0; i < batch.size(); i += BoardBatch::LANES) {
+        auto group = i / BoardBatch::LANES;
+        avx2Lanes(
+            batch.data() + group * groupRows, batch.height(), batch.firstRow(group),
+            masks, &out[i], std::min(BoardBatch::LANES, batch.size() - i));
+    }
+}
+
+#endif // BOARD_EVAL_X86
+
+} // namespace
+
+// ##################################################
+// BoardBatch
+BoardBatch::BoardBatch(std::size_t width, std::size_t height) :
+    width_(width)
+    , height_(height)
+{
+    assert(width > 0 && width <= Board::MAX_WIDTH);
+    assert(height > 0 && height <= MAX_HEIGHT);
+    emptyRow_ = row_t{1} | ~((row_t{1} << (width + 1)) - 1);
+}
+
+void BoardBatch::clear() {
+    size_ = 0;
+    rows_.clear();
+    firstRows_.clear();
+}
+
+void BoardBatch::add(const Board& board) {
+    assert(board.width() == width_ && board.height() == height_);
+    auto lane = size_ % LANES;
+    if (lane == 0) {
+        rows_.resize(rows_.size() + height_ * LANES, emptyRow_);
+        firstRows_.push_back(height_);
+    }
+    auto* group = rows_.data() + (size_ / LANES) * height_ * LANES;
+    auto rows = board.rows();
+    auto first = height_;
+    for (std::size_t y = 0; y < height_; ++y) {
+        group[y * LANES + lane] = rows[y];
+        if (first == height_ && rows[y] != emptyRow_) first = y;
+    }
+    auto& groupFirst = firstRows_.back();
+    groupFirst = std::min(groupFirst, first);
+    ++size_;
+}
+
+std::size_t BoardBatch::size() const {
+    return size_;
+}
+
+std::size_t BoardBatch::width() const {
+    return width_;
+}
+
+std::size_t BoardBatch::height() const {
+    return height_;
+}
+
+row_t BoardBatch::emptyRow() const {
+    return emptyRow_;
+}
+
+const row_t* BoardBatch::data() const {
+    return rows_.data();
+}
+
+std::size_t BoardBatch::firstRow(std::size_t group) const {
+    return firstRows_[group];
+}
+
+// ##################################################
+// kernels
+bool isSupported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::SCALAR:
+            return true;
+#ifdef BOARD_EVAL_X86
+        case Kernel::SSE:
+            return __builtin_cpu_supports("ssse3");
+        case Kernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+Kernel bestKernel() {
+    static const Kernel best = [] {
+        for (auto kernel : {Kernel::AVX2, Kernel::SSE}) {
+            if (isSupported(kernel)) return kernel;
+        }
+        return Kernel::SCALAR;
+    }();
+    return best;
+}
+
+const char* kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::SCALAR: return "scalar";
+        case Kernel::SSE: return "sse";
+        case Kernel::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+void evaluate(const BoardBatch& batch, std::span<Features> out, Kernel kernel) {
+    assert(out.size() >= batch.size() && isSupported(kernel));
+    switch (kernel) {
+        case Kernel::SCALAR:
+            evaluateScalar(batch, out);
+            break;
+#ifdef BOARD_EVAL_X86
+        case Kernel::SSE:
+            evaluateSse(batch, out);
+            break;
+        case Kernel::AVX2:
+            evaluateAvx2(batch, out);
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+Features evaluate(const Board& board) {
+    auto rows = board.rows();
+    auto first = static_cast<std::size_t>(
+        std::find_if(rows.begin(), rows.end() - 1, [&board](row_t row) {
+            return row != board.emptyRow();
+        }) - rows.begin());
+    return scalarFeatures(rows.data(), 1, board.height(), first, RowMasks(board.emptyRow()));
+}
+
+} // namespace board_eval
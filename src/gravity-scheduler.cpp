@@ -0,0 +1,190 @@
+#include "../include/gravity-scheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gravity_scheduler {
+
+// ##################################################
+// curves
+ConstantGravityCurve::ConstantGravityCurve(duration_t period) :
+    period_(period)
+{}
+
+duration_t ConstantGravityCurve::period(int) const {
+    return period_;
+}
+
+duration_t GuidelineGravityCurve::period(int level) const {
+    // past level 20 a row takes well under a millisecond
+    int l = std::clamp(level, 1, 20) - 1;
+    double seconds = std::pow(0.8 - l * 0.007, l);
+    return std::chrono::duration_cast<duration_t>(
+        std::chrono::duration<double>(seconds));
+}
+
+// ##################################################
+// SteadyClock
+time_point_t SteadyClock::now() const {
+    return std::chrono::steady_clock::now();
+}
+
+bool SteadyClock::waitUntil(
+    std::unique_lock<std::mutex>& lk, std::condition_variable& cv,
+    time_point_t deadline, const std::function<bool()>& ready) {
+    // wait_until() may overflow adding its own clock's offset to max()
+    if (deadline == time_point_t::max()) {
+        cv.wait(lk, ready);
+        return true;
+    }
+    return cv.wait_until(lk, deadline, ready);
+}
+
+// ##################################################
+// TickStats
+duration_t TickStats::meanLateness() const {
+    if (!ticks) return duration_t::zero();
+    return totalLateness / static_cast<duration_t::rep>(ticks);
+}
+
+// ##################################################
+// GravityScheduler
+GravityScheduler::GravityScheduler(
+    std::function<void()> onTick,
+    std::shared_ptr<GravityCurve> curve,
+    int level,
+    int softDropMultiplier,
+    std::shared_ptr<Clock> clock) :
+    onTick_(std::move(onTick))
+    , curve_(curve)
+    , clock_(clock)
+    , level_(level)
+    , softDropMultiplier_(std::max(softDropMultiplier, 1))
+{}
+
+void GravityScheduler::run() {
+    std::unique_lock<std::mutex> lk{mut_};
+    auto deadline = clock_->now() + period_();
+    while (!isStopped_) {
+        if (isPaused_) {
+            auto remaining = std::max(deadline - clock_->now(), duration_t::zero());
+            clock_->waitUntil(lk, cv_, time_point_t::max(), [this] {
+                return !isPaused_ || isStopped_;
+            });
+            deadline = clock_->now() + remaining;
+            continue;
+        }
+        if (isPeriodChanged_) {
+            isPeriodChanged_ = false;
+            deadline = std::min(deadline, clock_->now() + period_());
+        }
+
+        bool isInterrupted = clock_->waitUntil(lk, cv_, deadline, [this] {
+            return isStopped_ || isPaused_ || isPeriodChanged_;
+        });
+        if (isInterrupted) continue;
+
+        auto late = clock_->now() - deadline;
+        ++stats_.ticks;
+        stats_.lastLateness = late;
+        stats_.maxLateness = std::max(stats_.maxLateness, late);
+        stats_.totalLateness += late;
+
+        lk.unlock();
+        onTick_();
+        lk.lock();
+
+        // the next deadline is relative to this one, not to when onTick returned
+        auto period = period_();
+        deadline += period;
+        for (auto now = clock_->now(); deadline <= now; deadline += period) {
+            ++stats_.skippedTicks;
+        }
+    }
+}
+
+void GravityScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lk{mut_};
+        isStopped_ = true;
+    }
+    cv_.notify_all();
+}
+
+void GravityScheduler::pause() {
+    {
+        std::lock_guard<std::mutex> lk{mut_};
+        isPaused_ = true;
+    }
+    cv_.notify_all();
+}
+
+void GravityScheduler::resume() {
+    {
+        std::lock_guard<std::mutex> lk{mut_};
+        isPaused_ = false;
+    }
+    cv_.notify_all();
+}
+
+bool GravityScheduler::isPaused() const {
+    std::lock_guard<std::mutex> lk{mut_};
+    return isPaused_;
+}
+
+void GravityScheduler::setLevel(int level) {
+    {
+        std::lock_guard<std::mutex> lk{mut_};
+        level_ = level;
+        isPeriodChanged_ = true;
+    }
+    cv_.notify_all();
+}
+
+int GravityScheduler::level() const {
+    std::lock_guard<std::mutex> lk{mut_};
+    return level_;
+}
+
+void GravityScheduler::setSoftDrop(bool isOn) {
+    {
+        std::lock_guard<std::mutex> lk{mut_};
+        if (isSoftDrop_ == isOn) return;
+        isSoftDrop_ = isOn;
+        isPeriodChanged_ = true;
+    }
+    cv_.notify_all();
+}
+
+TickStats GravityScheduler::tickStats() const {
+    std::lock_guard<std::mutex> lk{mut_};
+    return stats_;
+}
+
+void GravityScheduler::update(
+    observer_n_subject::ISubject&, observer_n_subject::EventType event) {
+    using namespace observer_n_subject;
+    switch (event) {
+        case EventType::USER_ASKED_PAUSE_GAME: {
+            if (isPaused()) {
+                resume();
+            } else {
+                pause();
+            }
+            break;
+        }
+        case EventType::USER_ASKED_CLOSE_GAME:
+        case EventType::GAME_FINISH: {
+            stop();
+            break;
+        }
+        default: break;
+    }
+}
+
+duration_t GravityScheduler::period_() const {
+    auto period = curve_->period(level_);
+    return isSoftDrop_ ? period / softDropMultiplier_ : period;
+}
+
+} // namespace gravity_scheduler
@@ -0,0 +1,221 @@
+#include "../include/lookahead-bot.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <optional>
+
+#include "../include/zobrist.hpp"
+
+using placement_search::Board;
+using placement_search::Move;
+using placement_search::Placement;
+using tetrominoes::Tetromino;
+using tetrominoes::TetrominoType;
+
+namespace lookahead_bot {
+
+namespace {
+
+// no placement left for a tetromino, the game is over
+constexpr double LOSS = -1e9;
+
+// what a best value depends on, besides the weights and the options
+std::uint64_t tableKey(const Board& board, TetrominoType type, int depth) {
+    auto size = static_cast<std::uint64_t>(board.width()) << 40 | board.height() << 8;
+    return board.hash() ^ zobrist::tetrominoKey(type)
+        ^ zobrist::mix(size | static_cast<std::uint64_t>(depth));
+}
+
+} // namespace
+
+// ##################################################
+// evaluation
+double featuresValue(const board_eval::Features& features, const Weights& weights) {
+    return weights.aggregateHeight * features.aggregateHeight
+        + weights.holes * features.holes
+        + weights.bumpiness * features.bumpiness
+        + weights.wells * features.wells
+        + weights.rowTransitions * features.rowTransitions
+        + weights.columnTransitions * features.columnTransitions;
+}
+
+double evaluateBoard(const Board& board, const Weights& weights) {
+    return featuresValue(board_eval::evaluate(board), weights);
+}
+
+Tetromino spawnedTetromino(TetrominoType type, std::size_t fieldWidth) {
+    Tetromino tetromino(type);
+    for (std::size_t i = 0; i < fieldWidth / 2; ++i) {
+        tetromino.moveRightOneSquare();
+    }
+    return tetromino;
+}
+
+// ##################################################
+// LookaheadSearch
+LookaheadSearch::LookaheadSearch(
+    task_pool::TaskPool& pool, Weights weights, SearchOptions options) :
+    pool_(pool)
+    , weights_(weights)
+    , options_(options)
+{
+    if (options_.tableEntries) table_.emplace(options_.tableEntries);
+}
+
+Decision LookaheadSearch::decide(
+    const Board& board, const Tetromino& tetromino, std::stop_token stop) {
+    std::vector<Candidate> roots;
+    rankPlacements_(board, tetromino, roots);
+    Decision decision;
+    if (roots.empty()) return decision;
+    decision = {roots.front().placement, roots.front().value, 1};
+
+    auto count = std::min(options_.beamWidth, roots.size());
+    std::vector<double> values(count);
+    for (int depth = 2; depth <= options_.depth && !stop.stop_requested(); ++depth) {
+        task_pool::TaskGroup group(pool_);
+        for (std::size_t i = 0; i < count; ++i) {
+            group.run([&, i, depth] {
+                Board child = board;
+                auto lines = child.lock(tetromino.type(), roots[i].placement);
+                values[i] = weights_.linesCleared * lines + expectedValue_(child, depth - 1, stop);
+            });
+        }
+        group.wait();
+        // a stopped depth has values of shallower subtrees mixed in
+        if (stop.stop_requested()) break;
+        auto best = std::max_element(values.begin(), values.end()) - values.begin();
+        decision = {roots[best].placement, values[best], depth};
+    }
+    return decision;
+}
+
+std::uint64_t LookaheadSearch::nodesSearched() const {
+    return nodesSearched_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LookaheadSearch::tableHits() const {
+    return tableHits_.load(std::memory_order_relaxed);
+}
+
+void LookaheadSearch::rankPlacements_(
+    const Board& board, const Tetromino& tetromino, std::vector<Candidate>& out) {
+    // a task waiting on a group runs other tasks on its thread, nothing
+    // here may be used across the waiting
+    thread_local placement_search::PlacementSearch search;
+    thread_local std::optional<Board> scratch;
+    thread_local std::optional<board_eval::BoardBatch> batch;
+    thread_local std::vector<board_eval::Features> features;
+    // taller boards do not fit the batch, they take the scalar kernel
+    bool isBatched = board.height() <= board_eval::BoardBatch::MAX_HEIGHT;
+    if (isBatched) {
+        if (!batch || batch->width() != board.width() || batch->height() != board.height()) {
+            batch.emplace(board.width(), board.height());
+        }
+        batch->clear();
+    }
+    out.clear();
+    for (const auto& placement : search.search(board, tetromino)) {
+        scratch = board;
+        auto lines = scratch->lock(tetromino.type(), placement);
+        out.push_back({placement, weights_.linesCleared * lines});
+        if (isBatched) {
+            batch->add(*scratch);
+        } else {
+            out.back().value += evaluateBoard(*scratch, weights_);
+        }
+    }
+    if (isBatched) {
+        // every placement in one call of the kernel
+        features.resize(out.size());
+        board_eval::evaluate(*batch, features);
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            out[i].value += featuresValue(features[i], weights_);
+        }
+    }
+    nodesSearched_.fetch_add(1, std::memory_order_relaxed);
+    // ties stay in the order of the search, the same decision every time
+    std::stable_sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+        return a.value > b.value;
+    });
+}
+
+double LookaheadSearch::expectedValue_(
+    const Board& board, int depth, const std::stop_token& stop) {
+    std::array<double, tetrominoes::TYPES_COUNT> values {};
+    task_pool::TaskGroup group(pool_);
+    for (std::size_t type = 0; type < values.size(); ++type) {
+        group.run([&, type] {
+            values[type] = bestValue_(board, static_cast<TetrominoType>(type), depth, stop);
+        });
+    }
+    group.wait();
+    return std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+}
+
+double LookaheadSearch::bestValue_(
+    const Board& board, TetrominoType type, int depth, const std::stop_token& stop) {
+    if (stop.stop_requested()) return 0.0;
+    if (!table_) return searchBestValue_(board, type, depth, stop);
+    auto key = tableKey(board, type, depth);
+    if (auto value = table_->probe(key)) {
+        tableHits_.fetch_add(1, std::memory_order_relaxed);
+        return *value;
+    }
+    auto value = searchBestValue_(board, type, depth, stop);
+    // a stop on the way leaves values of shallower subtrees in it
+    if (!stop.stop_requested()) table_->store(key, value);
+    return value;
+}
+
+double LookaheadSearch::searchBestValue_(
+    const Board& board, TetrominoType type, int depth, const std::stop_token& stop) {
+    std::vector<Candidate> candidates;
+    rankPlacements_(board, spawnedTetromino(type, board.width()), candidates);
+    if (candidates.empty()) return LOSS;
+    if (depth == 1) return candidates.front().value;
+
+    auto best = -std::numeric_limits<double>::infinity();
+    auto count = std::min(options_.beamWidth, candidates.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        Board child = board;
+        auto lines = child.lock(type, candidates[i].placement);
+        best = std::max(best, weights_.linesCleared * lines + expectedValue_(child, depth - 1, stop));
+    }
+    return best;
+}
+
+// ##################################################
+// LookaheadPolicy
+LookaheadPolicy::LookaheadPolicy(
+    task_pool::TaskPool& pool, Weights weights, SearchOptions options) :
+    search_(pool, weights, options)
+{}
+
+void LookaheadPolicy::placeTetromino(tetris_game_model::TetrisGameModel& model) {
+    auto board = placement_search::lockedBoard(model);
+    const auto& tetromino = model.currentTetromino();
+    auto decision = search_.decide(board, tetromino);
+    if (!decision.depth) return;
+
+    // the placement's state belongs to another search
+    path_.clear();
+    for (const auto& placement : placementSearch_.search(board, tetromino)) {
+        if (placement_search::isSamePlacement(placement, decision.placement)) {
+            placementSearch_.path(placement, path_);
+            break;
+        }
+    }
+    for (auto move : path_) {
+        switch (move) {
+            case Move::LEFT: model.moveLeftTetromino(); break;
+            case Move::RIGHT: model.moveRightTetromino(); break;
+            case Move::ROTATE_RIGHT: model.rotateRightTetromino(); break;
+            case Move::DOWN: model.updateModel(); break;
+        }
+    }
+}
+
+} // namespace lookahead_bot
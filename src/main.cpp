@@ -1,71 +1,166 @@
 #include <atomic>
 #include <chrono>
+#include <cmath>
+#include <iostream>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <string_view>
 #include <thread>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 
+#include "../include/gravity-scheduler.hpp"
+#include "../include/lookahead-bot.hpp"
+#include "../include/perf-stats.hpp"
 #include "../include/player-input.hpp"
+#include "../include/render-target.hpp"
+#include "../include/sfml-render-target.hpp"
+#include "../include/terminal-render-target.hpp"
 #include "../include/tetris-game-controller.hpp"
 #include "../include/tetris-game-model.hpp"
 #include "../include/view.hpp"
 
-int main() {
-    using namespace std::chrono_literals;
-
+namespace {
+
+// sizes of the view in pixels of its render target
+struct ViewMetrics {
+    float gridWidth;
+    float gridHeight;
+    float gridThickness;
+    float frameThickness;
+    sf::Color frameColor;
+    float padding;
+    int textSize;
+    std::string font;
+};
+
+// perfStats adds the perf HUD below the score
+std::shared_ptr<view::DrawableStackLayout> makeView(
+    const ViewMetrics& m, std::shared_ptr<const perf_stats::PerfStats> perfStats) {
     auto grid = std::make_shared<view::DrawableGridCanvas>(
-        530.f, 1030.f, 21, 41, 5.f);
+        m.gridWidth, m.gridHeight, 21, 41, m.gridThickness);
     auto frame = std::make_shared<view::DrawableFrame>(
-        550.f, 1050.f, 5.f, sf::Color::White);
+        m.gridWidth + m.padding * 2, m.gridHeight + m.padding * 2, 
+        m.frameThickness, m.frameColor);
+
+    // the frame never changes, draw it from a texture
+    auto frameLayer = std::make_shared<view::DrawableRetainedLayer>();
+    frameLayer->addComponent(frame, "frame");
 
-    auto nestedL = std::make_shared<view::DrawableNestedLayout>(10.f, 10.f);
-    nestedL->addComponent(frame, "frame");
+    auto nestedL = std::make_shared<view::DrawableNestedLayout>(m.padding, m.padding);
+    nestedL->addComponent(frameLayer, "frame_layer");
     nestedL->addComponent(grid, "grid");
 
-    
     auto text = std::make_shared<view::DrawableText>(
-        "Your score:", 40, "calibri.ttf", sf::Color::Black, sf::Vector2f(10.f, 0.f));
+        "Your score:", m.textSize, m.font, sf::Color::Black, 
+        sf::Vector2f(m.padding, 0.f));
 
     auto stackL = std::make_shared<view::DrawableStackLayout>();
     stackL->addComponent(nestedL, "nestedL");
     stackL->addComponent(text, "score_text");
-    
-    std::pair<unsigned, unsigned> windowSz = stackL->size();
-    auto window = std::make_shared<sf::RenderWindow>(
-            sf::VideoMode({windowSz.first, windowSz.second}), "Tetris");
+    if (perfStats) {
+        auto hud = std::make_shared<view::DrawablePerfHud>(
+            std::move(perfStats), m.textSize, sf::Color::Black, sf::Vector2f(m.padding, 0.f));
+        stackL->addComponent(hud, "perf_hud");
+    }
+    return stackL;
+}
+
+} // namespace
+
+// `main --terminal` plays in the terminal instead of a window,
+// `--perf-hud` shows frame, model and latency percentiles under the score,
+// `--bot` plays by itself, the keys still pause and close
+int main(int argc, char** argv) {
+    using namespace std::chrono_literals;
+
+    bool isTerminal = false;
+    bool isBot = false;
+    std::shared_ptr<perf_stats::PerfStats> perfStats;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--terminal") {
+            isTerminal = true;
+        } else if (arg == "--bot") {
+            isBot = true;
+        } else if (arg == "--perf-hud") {
+            perfStats = std::make_shared<perf_stats::PerfStats>();
+        } else {
+            std::cerr << "unknown option " << arg << '\n';
+            return 1;
+        }
+    }
+
+    std::shared_ptr<view::DrawableStackLayout> stackL;
+    std::shared_ptr<sf::RenderWindow> window;
+    std::shared_ptr<render_target::IRenderTarget> target;
+    std::shared_ptr<player_input::IPlayerInput> input;
+    if (isTerminal) {
+#if defined(__unix__) || defined(__APPLE__)
+        // one pixel per dot, a character cell is two dots high
+        const sf::Vector2f cellSize(1.f, 2.f);
+        stackL = makeView({42.f, 82.f, 0.f, 1.f, sf::Color(60, 60, 60), 1.f, 2, ""}, perfStats);
+        auto sz = stackL->size();
+        target = std::make_shared<render_target::TerminalRenderTarget>(
+            static_cast<std::size_t>(std::ceil(sz.first / cellSize.x)),
+            static_cast<std::size_t>(std::ceil(sz.second / cellSize.y)),
+            cellSize, std::cout);
+        input = std::make_shared<player_input::TerminalInput>();
+#else
+        std::cerr << "terminal mode needs a POSIX terminal\n";
+        return 1;
+#endif
+    } else {
+        stackL = makeView({530.f, 1030.f, 5.f, 5.f, sf::Color::White, 10.f, 40, "calibri.ttf"}, perfStats);
+        std::pair<unsigned, unsigned> windowSz = stackL->size();
+        window = std::make_shared<sf::RenderWindow>(
+                sf::VideoMode({windowSz.first, windowSz.second}), "Tetris");
+        target = std::make_shared<render_target::SfmlRenderTarget>(*window);
+        input = std::make_shared<player_input::KeyBoardInput>(window);
+    }
 
     auto model = std::make_shared<TetrisGameModel>();
+    std::mutex modelMut;
 
-    auto input = std::make_shared<player_input::KeyBoardInput>(window);
+    std::shared_ptr<player_input::BotInput> bot;
+    if (isBot) {
+        // a move every 50 ms is slow enough to watch
+        bot = std::make_shared<player_input::BotInput>(
+            model, modelMut, input, lookahead_bot::SearchOptions{}, 50ms);
+        bot->registerAsObserver();
+        input = bot;
+    }
 
     auto controller 
-        = std::make_shared<tetris_game_controller::TetrisGameController>(model, input, window, stackL);
+        = std::make_shared<tetris_game_controller::TetrisGameController>(model, input, target, stackL);
     controller->registerAsObserver();
+    // no display refreshes faster, bursts of updates share a frame
+    controller->setFrameRateLimit(60);
+    controller->setPerfStats(perfStats);
 
     std::atomic_bool isGameRun = true;
     std::atomic_bool isGamePause = false;
-    std::mutex modelMut;
-
-    auto modelUpdater = [&] {
-        while (isGameRun) {
-            {
-                std::lock_guard<std::mutex> lk{modelMut};
-                model->updateModel();
-            }
-            std::this_thread::sleep_for(200ms);
-
-            while (isGamePause && isGameRun)
-                std::this_thread::yield(); 
-        };
-    };
 
-    std::thread t1(modelUpdater);
+    auto gravity = std::make_shared<gravity_scheduler::GravityScheduler>(
+        [&] {
+            // sampled like the controller's updates, it contends for the same mutex
+            perf_stats::withSampledLock(perfStats.get(), modelMut, [&] { model->updateModel(); });
+            // the tetromino is falling, the bot decides with what it has searched
+            if (bot) bot->forceDecision();
+        },
+        std::make_shared<gravity_scheduler::ConstantGravityCurve>(200ms));
+    model->attach(gravity, observer_n_subject::EventType::GAME_FINISH);
+    input->attach(gravity, observer_n_subject::EventType::USER_ASKED_PAUSE_GAME);
+    input->attach(gravity, observer_n_subject::EventType::USER_ASKED_CLOSE_GAME);
+
+    std::thread t1([&] { gravity->run(); });
     model->updateModel();
 
 
     controller->runModel(modelMut, isGameRun, isGamePause);
 
+    gravity->stop();
     t1.join();
 }
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "../include/placement-search.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "../include/zobrist.hpp"
+
+using tetris_game_model::BlockType;
+
+namespace placement_search {
+
+// ##################################################
+// Board
+Board::Board(std::size_t width, std::size_t height) :
+    width_(width)
+    , height_(height)
+{
+    assert(width > 0 && width <= MAX_WIDTH);
+    emptyRow_ = row_t{1} | ~((row_t{1} << (width + 1)) - 1);
+    rows_.assign(height + 1, emptyRow_);
+    rows_.back() = ~row_t{0};
+}
+
+void Board::set(std::size_t x, std::size_t y) {
+    if (test(x, y)) return;
+    rows_[y] |= row_t{1} << (x + 1);
+    hash_ ^= zobrist::blockKey(x, y);
+}
+
+void Board::reset(std::size_t x, std::size_t y) {
+    if (!test(x, y)) return;
+    rows_[y] &= ~(row_t{1} << (x + 1));
+    hash_ ^= zobrist::blockKey(x, y);
+}
+
+bool Board::test(std::size_t x, std::size_t y) const {
+    assert(x < width_ && y < height_);
+    return rows_[y] & (row_t{1} << (x + 1));
+}
+
+std::size_t Board::lock(tetrominoes::TetrominoType type, const Placement& placement) {
+    const auto& info = tetrominoes::shapeInfo(type, placement.rotation);
+    for (const auto& b : info.blocks) {
+        set(placement.column + b.first, placement.row + b.second);
+    }
+    // only the rows of the tetromino may have been filled
+    std::size_t deleted = 0;
+    for (int y = placement.row + info.height - 1; y >= 0; --y) {
+        if (rows_[y] == ~row_t{0}) {
+            ++deleted;
+            hash_ ^= zobrist::rowKey(blocks_(rows_[y]), y);
+        } else if (deleted) {
+            auto blocks = blocks_(rows_[y]);
+            hash_ ^= zobrist::rowKey(blocks, y) ^ zobrist::rowKey(blocks, y + deleted);
+            rows_[y + deleted] = rows_[y];
+        }
+        if (!deleted && y <= placement.row) break;
+    }
+    std::fill(rows_.begin(), rows_.begin() + deleted, emptyRow_);
+    return deleted;
+}
+
+std::size_t Board::width() const {
+    return width_;
+}
+
+std::size_t Board::height() const {
+    return height_;
+}
+
+std::span<const row_t> Board::rows() const {
+    return rows_;
+}
+
+row_t Board::emptyRow() const {
+    return emptyRow_;
+}
+
+std::uint64_t Board::hash() const {
+    return hash_;
+}
+
+std::uint64_t Board::blocks_(row_t row) const {
+    return (row & ~emptyRow_) >> 1;
+}
+
+Board lockedBoard(const tetris_game_model::TetrisGameModel& model) {
+    Board board(model.fieldWidth(), model.fieldHeight());
+    const auto& field = model.field();
+    const auto& tetromino = model.currentTetromino();
+    for (std::size_t y = 0; y < field.size(); ++y) {
+        for (std::size_t x = 0; x < field[y].size(); ++x) {
+            auto block = field[y][x];
+            if (block == BlockType::VOID || block == BlockType::GHOST) continue;
+            // a finished game leaves the last tetromino locked where it is
+            if (!model.isGameFinished() && tetromino.containsBlock(
+                    {static_cast<int>(x), static_cast<int>(y)})) continue;
+            board.set(x, y);
+        }
+    }
+    return board;
+}
+
+bool isSamePlacement(const Placement& a, const Placement& b) {
+    return a.column == b.column && a.row == b.row && a.rotation == b.rotation;
+}
+
+// ##################################################
+// PlacementSearch
+std::span<const Placement> PlacementSearch::search(
+    const Board& board, const tetrominoes::Tetromino& tetromino) {
+    rows_ = board.rows();
+    width_ = static_cast<int>(board.width());
+    height_ = static_cast<int>(board.height());
+    for (std::size_t r = 0; r < masks_.size(); ++r) {
+        const auto& info = tetrominoes::shapeInfo(tetromino.type(), r);
+        auto& mask = masks_[r];
+        mask = {info.width, info.height, {}};
+        for (const auto& b : info.blocks) {
+            mask.rows[b.second] |= row_t{1} << (b.first + 1);
+        }
+    }
+
+    auto states = tetrominoes::ROTATIONS_COUNT * width_ * height_;
+    visited_.assign((states + 63) / 64, 0);
+    if (parents_.size() < states) {
+        parents_.resize(states);
+        moves_.resize(states);
+        queue_.resize(states);
+    }
+    placements_.clear();
+    statesVisited_ = 0;
+    freeRows_ = 0;
+    while (freeRows_ < height_ && rows_[freeRows_] == board.emptyRow()) {
+        ++freeRows_;
+    }
+
+    auto rotation = tetromino.rotation();
+    int x = tetromino.leftmostPointOnX();
+    int y = tetromino.highestPointOnY();
+    if (!fits_(rotation, x, y)) {
+        return {};
+    }
+    start_ = state_(rotation, x, y);
+    visit_(rotation, x, y, start_, Move::DOWN);
+
+    for (std::size_t head = 0; head < statesVisited_; ++head) {
+        auto state = queue_[head];
+        auto r = state / (width_ * height_);
+        auto cell = static_cast<int>(state % (width_ * height_));
+        x = cell % width_;
+        y = cell / width_;
+
+        if (fits_(r, x, y + 1)) {
+            // every empty row on top is like the next one, fall through them
+            // at once; a rotation there may not reach lower than falling does
+            int drop = std::max(y + 1, freeRows_ - masks_[r].height);
+            visit_(r, x, drop, state, Move::DOWN);
+        } else {
+            placements_.push_back({
+                static_cast<std::int16_t>(x),
+                static_cast<std::int16_t>(y),
+                static_cast<std::uint8_t>(r),
+                state
+            });
+        }
+        if (fits_(r, x - 1, y)) {
+            visit_(r, x - 1, y, state, Move::LEFT);
+        }
+        if (fits_(r, x + 1, y)) {
+            visit_(r, x + 1, y, state, Move::RIGHT);
+        }
+        auto next = (r + 1) % tetrominoes::ROTATIONS_COUNT;
+        if (canRotate_(next, x, y)) {
+            visit_(next, x, y, state, Move::ROTATE_RIGHT);
+        }
+    }
+    return placements_;
+}
+
+void PlacementSearch::path(const Placement& placement, std::vector<Move>& out) const {
+    auto first = out.size();
+    auto row = [this](std::uint32_t state) {
+        return static_cast<int>(state % (width_ * height_)) / width_;
+    };
+    for (auto state = placement.state; state != start_; state = parents_[state]) {
+        auto count = moves_[state] == Move::DOWN ? row(state) - row(parents_[state]) : 1;
+        out.insert(out.end(), count, moves_[state]);
+    }
+    std::reverse(out.begin() + first, out.end());
+}
+
+std::size_t PlacementSearch::statesVisited() const {
+    return statesVisited_;
+}
+
+bool PlacementSearch::fits_(std::size_t rotation, int x, int y) const {
+    const auto& mask = masks_[rotation];
+    if (x < 0 || y < 0 || y + mask.height > height_) {
+        return false;
+    }
+    for (int i = 0; i < mask.height; ++i) {
+        if (rows_[y + i] & (mask.rows[i] << x)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// as the movement engines rotate: the rotated piece may not reach the
+// last column or the last row
+bool PlacementSearch::canRotate_(std::size_t rotation, int x, int y) const {
+    const auto& mask = masks_[rotation];
+    return x + mask.width < width_ && y + mask.height < height_ && fits_(rotation, x, y);
+}
+
+void PlacementSearch::visit_(
+    std::size_t rotation, int x, int y, std::uint32_t from, Move move) {
+    auto state = state_(rotation, x, y);
+    auto& word = visited_[state / 64];
+    auto bit = std::uint64_t{1} << (state % 64);
+    if (word & bit) return;
+    word |= bit;
+    parents_[state] = from;
+    moves_[state] = move;
+    queue_[statesVisited_++] = state;
+}
+
+std::uint32_t PlacementSearch::state_(std::size_t rotation, int x, int y) const {
+    return static_cast<std::uint32_t>((rotation * height_ + y) * width_ + x);
+}
+
+} // namespace placement_search
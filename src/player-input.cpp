@@ -4,6 +4,12 @@
 
 #include <SFML/Window.hpp>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
 namespace player_input {
 
 KeyBoardInput::KeyBoardInput(std::shared_ptr<sf::RenderWindow> window) :
@@ -67,5 +73,243 @@ void KeyBoardInput::fireUserAskedPauseGame_() {
     notify(observer_n_subject::EventType::USER_ASKED_PAUSE_GAME);
 }
 
+// ##################################################
+// BotInput
+BotInput::BotInput(
+    std::shared_ptr<tetris_game_model::TetrisGameModel> model,
+    std::mutex& modelMut,
+    std::shared_ptr<IPlayerInput> humanInput,
+    lookahead_bot::SearchOptions options,
+    std::chrono::milliseconds movePeriod) :
+    model_(std::move(model))
+    , modelMut_(modelMut)
+    , humanInput_(std::move(humanInput))
+    , movePeriod_(movePeriod)
+    , search_(pool_, {}, options)
+{
+    thinker_ = std::thread([this] { think_(); });
+}
+
+BotInput::~BotInput() {
+    {
+        std::lock_guard<std::mutex> lk{jobMut_};
+        isStopped_ = true;
+        stop_.request_stop();
+    }
+    jobCv_.notify_all();
+    thinker_.join();
+}
+
+void BotInput::registerAsObserver() {
+    if (!humanInput_) return;
+    humanInput_->attach(shared_from_this(), observer_n_subject::EventType::USER_ASKED_CLOSE_GAME);
+    humanInput_->attach(shared_from_this(), observer_n_subject::EventType::USER_ASKED_PAUSE_GAME);
+}
+
+void BotInput::pollInput() {
+    using placement_search::Move;
+    if (humanInput_) humanInput_->pollInput();
+    auto now = std::chrono::steady_clock::now();
+    if (isPaused_ || now - lastMoveAt_ < movePeriod_) return;
+
+    std::optional<placement_search::Board> board;
+    tetrominoes::Tetromino tetromino;
+    std::uint64_t piece = 0;
+    {
+        std::lock_guard<std::mutex> lk{modelMut_};
+        if (model_->isGameFinished()) return;
+        board = placement_search::lockedBoard(*model_);
+        tetromino = model_->currentTetromino();
+        piece = model_->piecesLocked();
+    }
+    if (piece != piece_) {
+        piece_ = piece;
+        askDecision_(std::move(*board), tetromino);
+        return;
+    }
+
+    std::optional<placement_search::Placement> target;
+    {
+        std::lock_guard<std::mutex> lk{jobMut_};
+        if (decidedJobId_ != lastJobId_) return;
+        target = decision_;
+    }
+    if (!target) {
+        // nowhere to go, the game is about to end
+        fireMove_(Move::DOWN);
+        return;
+    }
+
+    bool isReachable = false;
+    path_.clear();
+    for (const auto& placement : planner_.search(*board, tetromino)) {
+        if (placement_search::isSamePlacement(placement, *target)) {
+            planner_.path(placement, path_);
+            isReachable = true;
+            break;
+        }
+    }
+    if (!isReachable) {
+        // gravity took the tetromino past the way there
+        askDecision_(std::move(*board), tetromino);
+        return;
+    }
+    // a tetromino resting on its placement is locked by the next down
+    fireMove_(path_.empty() ? Move::DOWN : path_.front());
+    lastMoveAt_ = now;
+}
+
+void BotInput::forceDecision() {
+    std::lock_guard<std::mutex> lk{jobMut_};
+    stop_.request_stop();
+}
+
+void BotInput::update(
+    observer_n_subject::ISubject& subject, observer_n_subject::EventType event) {
+    if (event == observer_n_subject::EventType::USER_ASKED_PAUSE_GAME) {
+        isPaused_ = !isPaused_;
+    }
+    notify(event);
+}
+
+void BotInput::think_() {
+    std::unique_lock<std::mutex> lk{jobMut_};
+    for (;;) {
+        jobCv_.wait(lk, [this] { return isStopped_ || job_; });
+        if (isStopped_) return;
+        auto job = std::move(*job_);
+        job_.reset();
+        auto stop = job.stop.get_token();
+
+        lk.unlock();
+        auto decision = search_.decide(job.board, job.tetromino, stop);
+        lk.lock();
+
+        // a newer job is waiting, this one is of no use any more
+        if (job.id != lastJobId_) continue;
+        decidedJobId_ = job.id;
+        decision_.reset();
+        if (decision.depth) decision_ = decision.placement;
+    }
+}
+
+void BotInput::askDecision_(
+    placement_search::Board board, const tetrominoes::Tetromino& tetromino) {
+    std::lock_guard<std::mutex> lk{jobMut_};
+    // the search of the previous job, if it still runs
+    stop_.request_stop();
+    stop_ = std::stop_source();
+    job_ = Job{std::move(board), tetromino, ++lastJobId_, stop_};
+    jobCv_.notify_one();
+}
+
+void BotInput::fireMove_(placement_search::Move move) {
+    using observer_n_subject::EventType;
+    switch (move) {
+        case placement_search::Move::LEFT:
+            notify(EventType::USER_ASKED_LEFT);
+            break;
+        case placement_search::Move::RIGHT:
+            notify(EventType::USER_ASKED_RIGHT);
+            break;
+        case placement_search::Move::ROTATE_RIGHT:
+            notify(EventType::USER_ASKED_ROTATE_RIGHT);
+            break;
+        case placement_search::Move::DOWN:
+            notify(EventType::USER_ASKED_DOWN);
+            break;
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+// ##################################################
+// TerminalInput
+struct TerminalInput::SavedMode {
+    termios mode;
+};
+
+TerminalInput::TerminalInput(int fd) :
+    fd_(fd)
+{
+    termios mode;
+    if (tcgetattr(fd_, &mode) != 0) return;
+    savedMode_ = std::make_unique<SavedMode>(mode);
+    // byte by byte, no echo, Ctrl-C arrives as a byte
+    mode.c_lflag &= ~(ICANON | ECHO | ISIG);
+    mode.c_cc[VMIN] = 0;
+    mode.c_cc[VTIME] = 0;
+    tcsetattr(fd_, TCSANOW, &mode);
+}
+
+TerminalInput::~TerminalInput() {
+    if (savedMode_) {
+        tcsetattr(fd_, TCSANOW, &savedMode_->mode);
+    }
+}
+
+void TerminalInput::pollInput() {
+    char buf[64];
+    pollfd pfd {fd_, POLLIN, 0};
+    while (poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLIN | POLLHUP))) {
+        auto n = read(fd_, buf, sizeof(buf));
+        if (n <= 0) {
+            notify(observer_n_subject::EventType::USER_ASKED_CLOSE_GAME);
+            return;
+        }
+        pending_.append(buf, static_cast<std::size_t>(n));
+    }
+    parse_();
+}
+
+void TerminalInput::parse_() {
+    using observer_n_subject::EventType;
+    std::size_t i = 0;
+    while (i < pending_.size()) {
+        char ch = pending_[i];
+        if (ch == '\x1b') {
+            // ESC [ X or ESC O X, wait for the rest if it is not here yet
+            if (i + 1 == pending_.size()) break;
+            char kind = pending_[i + 1];
+            if (kind != '[' && kind != 'O') {
+                ++i;
+                continue;
+            }
+            if (i + 2 == pending_.size()) break;
+            switch (pending_[i + 2]) {
+                case 'A':
+                    notify(EventType::USER_ASKED_ROTATE_RIGHT);
+                    break;
+                case 'B':
+                    notify(EventType::USER_ASKED_DOWN);
+                    notify(EventType::USER_ASKED_DOWN);
+                    notify(EventType::USER_ASKED_DOWN);
+                    break;
+                case 'C':
+                    notify(EventType::USER_ASKED_RIGHT);
+                    break;
+                case 'D':
+                    notify(EventType::USER_ASKED_LEFT);
+                    break;
+            }
+            i += 3;
+            continue;
+        }
+        switch (ch) {
+            case '\t':
+                notify(EventType::USER_ASKED_PAUSE_GAME);
+                break;
+            case 'q':
+            case '\x03':
+            case '\x04':
+                notify(EventType::USER_ASKED_CLOSE_GAME);
+                break;
+        }
+        ++i;
+    }
+    pending_.erase(0, i);
+}
+
+#endif
 
 } // namespace player_input
\ No newline at end of file
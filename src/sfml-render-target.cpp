@@ -0,0 +1,118 @@
+#include "../include/sfml-render-target.hpp"
+
+#include <cassert>
+
+#include <SFML/System/Exception.hpp>
+
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/Text.hpp>
+
+#include "../include/bitmap-font.hpp"
+
+namespace {
+
+void appendRect(std::vector<sf::Vertex>& out, sf::FloatRect rect, sf::Color color) {
+    auto p = rect.position;
+    auto s = rect.size;
+    sf::Vector2f corners[4] = {
+        p, {p.x + s.x, p.y}, {p.x, p.y + s.y}, {p.x + s.x, p.y + s.y}
+    };
+    for (auto i : {0, 1, 2, 2, 1, 3}) {
+        out.push_back({corners[i], color});
+    }
+}
+
+class SfmlRenderLayer final : public render_target::IRenderLayer {
+public:
+    explicit SfmlRenderLayer(sf::Vector2u size) :
+        texture_(size)
+        , target_(texture_)
+    {}
+
+    render_target::IRenderTarget& target() override {
+        return target_;
+    }
+
+    const sf::Texture& texture() const {
+        return texture_.getTexture();
+    }
+
+private:
+    sf::RenderTexture texture_;
+    render_target::SfmlRenderTarget target_;
+};
+
+} // namespace
+
+namespace render_target {
+
+SfmlRenderTarget::SfmlRenderTarget(sf::RenderWindow& window) :
+    target_(window)
+    , window_(&window)
+{}
+
+SfmlRenderTarget::SfmlRenderTarget(sf::RenderTexture& texture) :
+    target_(texture)
+    , texture_(&texture)
+{}
+
+sf::Vector2u SfmlRenderTarget::size() const {
+    return target_.getSize();
+}
+
+void SfmlRenderTarget::clear(sf::Color color) {
+    target_.clear(color);
+}
+
+void SfmlRenderTarget::fillRect(sf::FloatRect rect, sf::Color color) {
+    scratch_.clear();
+    appendRect(scratch_, rect, color);
+    target_.draw(scratch_.data(), scratch_.size(), sf::PrimitiveType::Triangles);
+}
+
+void SfmlRenderTarget::drawTriangles(
+    std::span<const sf::Vertex> vertices, sf::Vector2f offset) {
+    sf::RenderStates states;
+    states.transform.translate(offset);
+    target_.draw(vertices.data(), vertices.size(), sf::PrimitiveType::Triangles, states);
+}
+
+void SfmlRenderTarget::drawText(const TextRun& text) {
+    if (text.sfText) {
+        target_.draw(*text.sfText);
+        return;
+    }
+    scratch_.clear();
+    bitmap_font::forEachPixel(
+        text.text, text.characterSize, text.position.x, text.position.y,
+        [&](float x, float y, float side) {
+            appendRect(scratch_, {{x, y}, {side, side}}, text.color);
+        });
+    target_.draw(scratch_.data(), scratch_.size(), sf::PrimitiveType::Triangles);
+}
+
+void SfmlRenderTarget::display() {
+    if (window_) window_->display();
+    if (texture_) texture_->display();
+}
+
+bool SfmlRenderTarget::setActive(bool isActive) {
+    return target_.setActive(isActive);
+}
+
+std::unique_ptr<IRenderLayer> SfmlRenderTarget::createLayer(sf::Vector2u size) {
+    try {
+        return std::make_unique<SfmlRenderLayer>(size);
+    } catch (const sf::Exception&) {
+        return nullptr;
+    }
+}
+
+void SfmlRenderTarget::drawLayer(IRenderLayer& layer, sf::Vector2f position) {
+    assert(dynamic_cast<SfmlRenderLayer*>(&layer));
+    sf::Sprite sprite(static_cast<SfmlRenderLayer&>(layer).texture());
+    sprite.setPosition(position);
+    target_.draw(sprite);
+}
+
+} // namespace render_target
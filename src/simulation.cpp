@@ -0,0 +1,38 @@
+#include "../include/simulation.hpp"
+
+using tetris_game_model::TetrisGameModel;
+
+namespace simulation {
+
+// ##################################################
+// DropPolicy
+void DropPolicy::placeTetromino(TetrisGameModel&) {}
+
+// ##################################################
+// RandomPolicy
+RandomPolicy::RandomPolicy(std::uint64_t seed) :
+    gen_(seed)
+{}
+
+void RandomPolicy::placeTetromino(TetrisGameModel& model) {
+    auto rotations = gen_() % 4;
+    for (std::uint64_t i = 0; i < rotations; ++i) {
+        model.rotateRightTetromino();
+    }
+    auto width = static_cast<std::int64_t>(model.fieldWidth());
+    auto shift = static_cast<std::int64_t>(gen_() % width) - width / 2;
+    for (; shift < 0 && model.moveLeftTetromino(); ++shift) {}
+    for (; shift > 0 && model.moveRightTetromino(); --shift) {}
+}
+
+// ##################################################
+// playGame
+GameResult playGame(TetrisGameModel& model, Policy& policy, std::uint64_t maxPieces) {
+    while (!model.isGameFinished() && (maxPieces == 0 || model.piecesLocked() < maxPieces)) {
+        policy.placeTetromino(model);
+        model.hardDropTetromino();
+    }
+    return {model.piecesLocked(), model.linesCleared(), model.score(), model.isGameFinished()};
+}
+
+} // namespace simulation
@@ -0,0 +1,217 @@
+#include "../include/software-render-target.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+
+#include "../include/bitmap-font.hpp"
+
+namespace {
+
+// first pixel whose centre is at or after the coordinate
+std::ptrdiff_t firstPixel(float coord) {
+    return static_cast<std::ptrdiff_t>(std::ceil(coord - 0.5f));
+}
+
+float cross(sf::Vector2f a, sf::Vector2f b, sf::Vector2f p) {
+    return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+// of two triangles sharing an edge exactly one owns the pixels on it
+bool ownsEdge(sf::Vector2f a, sf::Vector2f b) {
+    auto dx = b.x - a.x;
+    auto dy = b.y - a.y;
+    return dy > 0 || (dy == 0 && dx < 0);
+}
+
+class SoftwareRenderLayer final : public render_target::IRenderLayer {
+public:
+    SoftwareRenderLayer(sf::Vector2u size) :
+        target_(size.x, size.y)
+    {}
+
+    render_target::IRenderTarget& target() override {
+        return target_;
+    }
+
+    const render_target::SoftwareRenderTarget& surface() const {
+        return target_;
+    }
+
+private:
+    render_target::SoftwareRenderTarget target_;
+};
+
+} // namespace
+
+namespace render_target {
+
+SoftwareRenderTarget::SoftwareRenderTarget(std::size_t width, std::size_t height) :
+    width_(width)
+    , height_(height)
+    , pixels_(width * height * 4, 0)
+{}
+
+sf::Vector2u SoftwareRenderTarget::size() const {
+    return {static_cast<unsigned>(width_), static_cast<unsigned>(height_)};
+}
+
+void SoftwareRenderTarget::clear(sf::Color color) {
+    for (std::size_t i = 0; i < pixels_.size(); i += 4) {
+        pixels_[i] = color.r;
+        pixels_[i + 1] = color.g;
+        pixels_[i + 2] = color.b;
+        pixels_[i + 3] = color.a;
+    }
+}
+
+void SoftwareRenderTarget::fillRect(sf::FloatRect rect, sf::Color color) {
+    if (color.a == 0) return;
+    auto x0 = std::max<std::ptrdiff_t>(firstPixel(rect.position.x), 0);
+    auto y0 = std::max<std::ptrdiff_t>(firstPixel(rect.position.y), 0);
+    auto x1 = std::min<std::ptrdiff_t>(firstPixel(rect.position.x + rect.size.x), width_);
+    auto y1 = std::min<std::ptrdiff_t>(firstPixel(rect.position.y + rect.size.y), height_);
+    if (x0 >= x1) return;
+    for (auto y = y0; y < y1; ++y) {
+        fillSpan_(y, x0, x1, color);
+    }
+}
+
+void SoftwareRenderTarget::drawTriangles(
+    std::span<const sf::Vertex> vertices, sf::Vector2f offset) {
+    for (std::size_t i = 0; i + 2 < vertices.size(); i += 3) {
+        fillTriangle_(
+            vertices[i].position + offset,
+            vertices[i + 1].position + offset,
+            vertices[i + 2].position + offset,
+            vertices[i].color);
+    }
+}
+
+void SoftwareRenderTarget::drawText(const TextRun& text) {
+    bitmap_font::forEachPixel(
+        text.text, text.characterSize, text.position.x, text.position.y,
+        [&](float x, float y, float side) {
+            fillRect({{x, y}, {side, side}}, text.color);
+        });
+}
+
+void SoftwareRenderTarget::display() {}
+
+std::unique_ptr<IRenderLayer> SoftwareRenderTarget::createLayer(sf::Vector2u size) {
+    return std::make_unique<SoftwareRenderLayer>(size);
+}
+
+void SoftwareRenderTarget::drawLayer(IRenderLayer& layer, sf::Vector2f position) {
+    assert(dynamic_cast<SoftwareRenderLayer*>(&layer));
+    const auto& surface = static_cast<SoftwareRenderLayer&>(layer).surface();
+    auto sz = surface.size();
+    auto offsetX = firstPixel(position.x + 0.5f);
+    auto offsetY = firstPixel(position.y + 0.5f);
+    for (std::size_t y = 0; y < sz.y; ++y) {
+        auto dstY = offsetY + static_cast<std::ptrdiff_t>(y);
+        if (dstY < 0 || dstY >= static_cast<std::ptrdiff_t>(height_)) continue;
+        for (std::size_t x = 0; x < sz.x; ++x) {
+            auto dstX = offsetX + static_cast<std::ptrdiff_t>(x);
+            if (dstX < 0 || dstX >= static_cast<std::ptrdiff_t>(width_)) continue;
+            blendPixel_(dstX, dstY, surface.pixel(x, y));
+        }
+    }
+}
+
+std::span<const std::uint8_t> SoftwareRenderTarget::pixels() const {
+    return pixels_;
+}
+
+sf::Color SoftwareRenderTarget::pixel(std::size_t x, std::size_t y) const {
+    assert(x < width_ && y < height_);
+    const auto* p = &pixels_[(y * width_ + x) * 4];
+    return {p[0], p[1], p[2], p[3]};
+}
+
+bool SoftwareRenderTarget::saveToPpm(const char* path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out << "P6\n" << width_ << ' ' << height_ << "\n255\n";
+    for (std::size_t i = 0; i < pixels_.size(); i += 4) {
+        out.write(reinterpret_cast<const char*>(&pixels_[i]), 3);
+    }
+    return static_cast<bool>(out);
+}
+
+void SoftwareRenderTarget::blendPixel_(std::size_t x, std::size_t y, sf::Color color) {
+    auto* p = &pixels_[(y * width_ + x) * 4];
+    if (color.a == 255) {
+        p[0] = color.r;
+        p[1] = color.g;
+        p[2] = color.b;
+        p[3] = 255;
+        return;
+    }
+    if (color.a == 0) return;
+    unsigned a = color.a;
+    unsigned ia = 255 - a;
+    p[0] = static_cast<std::uint8_t>((color.r * a + p[0] * ia + 127) / 255);
+    p[1] = static_cast<std::uint8_t>((color.g * a + p[1] * ia + 127) / 255);
+    p[2] = static_cast<std::uint8_t>((color.b * a + p[2] * ia + 127) / 255);
+    p[3] = static_cast<std::uint8_t>(a + (p[3] * ia + 127) / 255);
+}
+
+void SoftwareRenderTarget::fillSpan_(
+    std::size_t y, std::size_t fromX, std::size_t toX, sf::Color color) {
+    if (color.a != 255) {
+        for (auto x = fromX; x < toX; ++x) {
+            blendPixel_(x, y, color);
+        }
+        return;
+    }
+    auto* p = &pixels_[(y * width_ + fromX) * 4];
+    for (auto x = fromX; x < toX; ++x, p += 4) {
+        p[0] = color.r;
+        p[1] = color.g;
+        p[2] = color.b;
+        p[3] = 255;
+    }
+}
+
+void SoftwareRenderTarget::fillTriangle_(
+    sf::Vector2f a, sf::Vector2f b, sf::Vector2f c, sf::Color color) {
+    if (color.a == 0) return;
+    auto area = cross(a, b, c);
+    if (area == 0) return;
+    if (area < 0) std::swap(b, c);
+
+    auto x0 = std::max<std::ptrdiff_t>(firstPixel(std::min({a.x, b.x, c.x})), 0);
+    auto y0 = std::max<std::ptrdiff_t>(firstPixel(std::min({a.y, b.y, c.y})), 0);
+    auto x1 = std::min<std::ptrdiff_t>(firstPixel(std::max({a.x, b.x, c.x})) + 1, width_);
+    auto y1 = std::min<std::ptrdiff_t>(firstPixel(std::max({a.y, b.y, c.y})) + 1, height_);
+
+    bool ownsAB = ownsEdge(a, b);
+    bool ownsBC = ownsEdge(b, c);
+    bool ownsCA = ownsEdge(c, a);
+    auto isInside = [](float w, bool owns) { return w > 0 || (w == 0 && owns); };
+
+    for (auto y = y0; y < y1; ++y) {
+        // the covered pixels of a row are contiguous
+        std::ptrdiff_t spanBegin = -1;
+        std::ptrdiff_t spanEnd = -1;
+        for (auto x = x0; x < x1; ++x) {
+            sf::Vector2f p {x + 0.5f, y + 0.5f};
+            bool inside = isInside(cross(a, b, p), ownsAB)
+                       && isInside(cross(b, c, p), ownsBC)
+                       && isInside(cross(c, a, p), ownsCA);
+            if (inside) {
+                if (spanBegin < 0) spanBegin = x;
+                spanEnd = x + 1;
+            } else if (spanBegin >= 0) {
+                break;
+            }
+        }
+        if (spanBegin >= 0) {
+            fillSpan_(y, spanBegin, spanEnd, color);
+        }
+    }
+}
+
+} // namespace render_target
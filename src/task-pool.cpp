@@ -0,0 +1,137 @@
+#include "../include/task-pool.hpp"
+
+#include <algorithm>
+
+namespace task_pool {
+
+namespace {
+
+// the pool and the deque of the worker running on this thread
+thread_local const TaskPool* currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+} // namespace
+
+// ##################################################
+// TaskPool
+TaskPool::TaskPool(std::size_t threads) {
+    threads = std::max<std::size_t>(threads, 1);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i + 1 < threads; ++i) {
+        threads_.emplace_back([this, i] { workerLoop_(i); });
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lk{sleepMut_};
+        isStopped_ = true;
+    }
+    sleepCv_.notify_all();
+    for (auto& t : threads_) {
+        t.join();
+    }
+}
+
+std::size_t TaskPool::threadCount() const {
+    return workers_.size();
+}
+
+std::uint64_t TaskPool::tasksRun() const {
+    return tasksRun_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t TaskPool::tasksStolen() const {
+    return tasksStolen_.load(std::memory_order_relaxed);
+}
+
+void TaskPool::push_(Task task) {
+    auto self = currentPool == this ? currentWorker : workers_.size() - 1;
+    {
+        auto& worker = *workers_[self];
+        std::lock_guard<std::mutex> lk{worker.mut};
+        worker.tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lk{sleepMut_};
+    }
+    sleepCv_.notify_one();
+}
+
+bool TaskPool::runOne_() {
+    auto self = currentPool == this ? currentWorker : workers_.size() - 1;
+    Task task;
+    if (!pop_(self, task)) return false;
+    task.func();
+    tasksRun_.fetch_add(1, std::memory_order_relaxed);
+    // the group may be gone as soon as its last task is counted
+    task.group->pending_.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+// the newest task of its own deque, else the oldest one of another
+bool TaskPool::pop_(std::size_t self, Task& task) {
+    if (queued_.load(std::memory_order_acquire) == 0) return false;
+    {
+        auto& worker = *workers_[self];
+        std::lock_guard<std::mutex> lk{worker.mut};
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    for (std::size_t i = 1; i < workers_.size(); ++i) {
+        auto& victim = *workers_[(self + i) % workers_.size()];
+        std::lock_guard<std::mutex> lk{victim.mut};
+        if (victim.tasks.empty()) continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        tasksStolen_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void TaskPool::workerLoop_(std::size_t self) {
+    currentPool = this;
+    currentWorker = self;
+    for (;;) {
+        if (runOne_()) continue;
+        std::unique_lock<std::mutex> lk{sleepMut_};
+        sleepCv_.wait(lk, [this] {
+            return isStopped_ || queued_.load(std::memory_order_acquire) != 0;
+        });
+        if (isStopped_) return;
+    }
+}
+
+// ##################################################
+// TaskGroup
+TaskGroup::TaskGroup(TaskPool& pool) :
+    pool_(pool)
+{}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+void TaskGroup::run(std::function<void()> func) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    pool_.push_({std::move(func), this});
+}
+
+void TaskGroup::wait() {
+    while (pending_.load(std::memory_order_acquire) != 0) {
+        if (!pool_.runOne_()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+} // namespace task_pool
@@ -0,0 +1,252 @@
+#include "../include/terminal-render-target.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <string_view>
+
+namespace {
+
+// a jump over at most this many unchanged cells may be replaced by
+// rewriting them when that is shorter
+constexpr std::size_t MAX_REWRITE_GAP = 4;
+
+constexpr std::string_view UPPER_HALF_BLOCK = "\xe2\x96\x80";
+
+void appendNumber(std::string& out, std::size_t value) {
+    std::array<char, 20> buf;
+    auto [end, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), value);
+    out.append(buf.data(), end);
+}
+
+void appendColor(std::string& out, char layer, sf::Color color) {
+    out += layer;
+    out += "8;2;";
+    appendNumber(out, color.r);
+    out += ';';
+    appendNumber(out, color.g);
+    out += ';';
+    appendNumber(out, color.b);
+}
+
+std::ptrdiff_t cellIndex(float coord, float cellSide) {
+    return static_cast<std::ptrdiff_t>(std::floor(coord / cellSide));
+}
+
+} // namespace
+
+namespace render_target {
+
+TerminalRenderTarget::TerminalRenderTarget(
+    std::size_t columns, std::size_t rows, sf::Vector2f cellSize, std::ostream& out) :
+    columns_(columns)
+    , rows_(rows)
+    , cellSize_(cellSize)
+    , out_(out)
+    , dots_(columns, rows * 2)
+    , textChars_(columns * rows, 0)
+    , textColors_(columns * rows)
+    , cells_(columns * rows)
+    , shadow_(columns * rows)
+{}
+
+TerminalRenderTarget::~TerminalRenderTarget() {
+    if (!isScreenValid_) return;
+    // leave the cursor below the picture with default attributes
+    std::string tail = "\x1b[0m\x1b[";
+    appendNumber(tail, rows_);
+    tail += ";1H\r\n\x1b[?25h";
+    out_.write(tail.data(), tail.size());
+    out_.flush();
+}
+
+sf::Vector2u TerminalRenderTarget::size() const {
+    return {
+        static_cast<unsigned>(std::ceil(columns_ * cellSize_.x)),
+        static_cast<unsigned>(std::ceil(rows_ * cellSize_.y))
+    };
+}
+
+void TerminalRenderTarget::clear(sf::Color color) {
+    dots_.clear(color);
+    std::fill(textChars_.begin(), textChars_.end(), 0);
+}
+
+void TerminalRenderTarget::fillRect(sf::FloatRect rect, sf::Color color) {
+    sf::Vector2f scale(1.f / cellSize_.x, 2.f / cellSize_.y);
+    dots_.fillRect({
+        {rect.position.x * scale.x, rect.position.y * scale.y},
+        {rect.size.x * scale.x, rect.size.y * scale.y}
+    }, color);
+}
+
+void TerminalRenderTarget::drawTriangles(
+    std::span<const sf::Vertex> vertices, sf::Vector2f offset) {
+    sf::Vector2f scale(1.f / cellSize_.x, 2.f / cellSize_.y);
+    scratchVertices_.assign(vertices.begin(), vertices.end());
+    for (auto& v : scratchVertices_) {
+        v.position = {(v.position.x + offset.x) * scale.x, (v.position.y + offset.y) * scale.y};
+    }
+    dots_.drawTriangles(scratchVertices_, {0.f, 0.f});
+}
+
+void TerminalRenderTarget::drawText(const TextRun& text) {
+    auto row = cellIndex(text.position.y, cellSize_.y);
+    if (row < 0 || row >= static_cast<std::ptrdiff_t>(rows_)) return;
+    auto col = cellIndex(text.position.x, cellSize_.x);
+    for (auto ch : text.text) {
+        if (col >= static_cast<std::ptrdiff_t>(columns_)) break;
+        if (col >= 0) {
+            auto idx = static_cast<std::size_t>(row) * columns_ + col;
+            textChars_[idx] = (ch >= ' ' && ch <= '~') ? ch : '?';
+            textColors_[idx] = text.color;
+        }
+        ++col;
+    }
+}
+
+void TerminalRenderTarget::display() {
+    composeCells_();
+    frame_.clear();
+    if (!isScreenValid_) {
+        // hide the cursor and start from a blank screen
+        frame_ += "\x1b[?25l\x1b[0m\x1b[2J";
+        pen_ = {};
+        isCursorKnown_ = false;
+    }
+
+    std::size_t changed = 0;
+    for (std::size_t row = 0; row < rows_; ++row) {
+        for (std::size_t col = 0; col < columns_; ++col) {
+            const auto& cell = cells_[row * columns_ + col];
+            if (isScreenValid_ && cell == shadow_[row * columns_ + col]) continue;
+            moveCursor_(row, col);
+            putCell_(frame_, pen_, cell);
+            // past the last column the terminal waits to wrap, which \r\n handles
+            cursorCol_ = col + 1;
+            ++changed;
+        }
+    }
+    cells_.swap(shadow_);
+    isScreenValid_ = true;
+
+    lastFrameBytes_ = frame_.size();
+    lastFrameCells_ = changed;
+    if (frame_.empty()) return;
+    out_.write(frame_.data(), frame_.size());
+    out_.flush();
+}
+
+std::unique_ptr<IRenderLayer> TerminalRenderTarget::createLayer(sf::Vector2u) {
+    return nullptr;
+}
+
+// no layer comes from createLayer(), so there is never one to draw
+void TerminalRenderTarget::drawLayer(IRenderLayer&, sf::Vector2f) {}
+
+void TerminalRenderTarget::invalidateScreen() {
+    isScreenValid_ = false;
+}
+
+std::size_t TerminalRenderTarget::columns() const {
+    return columns_;
+}
+
+std::size_t TerminalRenderTarget::rows() const {
+    return rows_;
+}
+
+std::size_t TerminalRenderTarget::lastFrameBytes() const {
+    return lastFrameBytes_;
+}
+
+std::size_t TerminalRenderTarget::lastFrameCells() const {
+    return lastFrameCells_;
+}
+
+void TerminalRenderTarget::composeCells_() {
+    for (std::size_t row = 0; row < rows_; ++row) {
+        for (std::size_t col = 0; col < columns_; ++col) {
+            auto idx = row * columns_ + col;
+            auto top = dots_.pixel(col, row * 2);
+            auto bottom = dots_.pixel(col, row * 2 + 1);
+            top.a = 255;
+            bottom.a = 255;
+            auto& cell = cells_[idx];
+            // spaces of a text leave the picture under them visible
+            if (textChars_[idx] && textChars_[idx] != ' ') {
+                cell = {textChars_[idx], textColors_[idx], top};
+                cell.fg.a = 255;
+            } else if (top == bottom) {
+                // a space needs only the background colour
+                cell = {' ', bottom, bottom};
+            } else {
+                cell = {0, top, bottom};
+            }
+        }
+    }
+}
+
+void TerminalRenderTarget::moveCursor_(std::size_t row, std::size_t col) {
+    if (isCursorKnown_ && cursorRow_ == row) {
+        if (cursorCol_ == col) return;
+        if (cursorCol_ < col) {
+            std::string jump = "\x1b[";
+            appendNumber(jump, col - cursorCol_);
+            jump += 'C';
+            if (col - cursorCol_ <= MAX_REWRITE_GAP) {
+                // the cells in between are unchanged, writing them again
+                // moves the cursor too
+                scratchFrame_.clear();
+                auto pen = pen_;
+                for (auto c = cursorCol_; c < col; ++c) {
+                    putCell_(scratchFrame_, pen, cells_[row * columns_ + c]);
+                }
+                if (scratchFrame_.size() <= jump.size()) {
+                    frame_ += scratchFrame_;
+                    pen_ = pen;
+                    return;
+                }
+            }
+            frame_ += jump;
+            return;
+        }
+    }
+    if (isCursorKnown_ && row == cursorRow_ + 1 && col == 0) {
+        frame_ += "\r\n";
+    } else {
+        frame_ += "\x1b[";
+        appendNumber(frame_, row + 1);
+        frame_ += ';';
+        appendNumber(frame_, col + 1);
+        frame_ += 'H';
+    }
+    cursorRow_ = row;
+    isCursorKnown_ = true;
+}
+
+void TerminalRenderTarget::putCell_(std::string& out, Pen& pen, const Cell& cell) {
+    bool isFgNeeded = cell.ch != ' ' && pen.fg != cell.fg;
+    bool isBgNeeded = pen.bg != cell.bg;
+    if (isFgNeeded || isBgNeeded) {
+        out += "\x1b[";
+        if (isFgNeeded) {
+            appendColor(out, '3', cell.fg);
+            pen.fg = cell.fg;
+        }
+        if (isFgNeeded && isBgNeeded) out += ';';
+        if (isBgNeeded) {
+            appendColor(out, '4', cell.bg);
+            pen.bg = cell.bg;
+        }
+        out += 'm';
+    }
+    if (cell.ch) {
+        out += cell.ch;
+    } else {
+        out += UPPER_HALF_BLOCK;
+    }
+}
+
+} // namespace render_target
@@ -1,27 +1,75 @@
 #include "../include/tetris-game-controller.hpp"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <chrono>
-#include <iostream>
-#include <sstream>
+#include <span>
+#include <string_view>
 #include <thread>
+#include <utility>
 #include <cassert>
+#include <ctime>
+
+namespace {
+
+std::int64_t sinceEpochNs(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+// CPU time of the calling thread, 0 where there is no clock for it
+std::chrono::nanoseconds threadCpuTime() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+    }
+#endif
+    return std::chrono::nanoseconds(0);
+}
+
+} // namespace
 
 namespace tetris_game_controller {
 
+std::chrono::nanoseconds FrameStats::meanLatency() const {
+    if (!framesPresented) return std::chrono::nanoseconds::zero();
+    return totalLatency / static_cast<std::chrono::nanoseconds::rep>(framesPresented);
+}
+
 TetrisGameController::TetrisGameController(
     std::shared_ptr<tetris_game_model::TetrisGameModel> gameModel,
     std::shared_ptr<player_input::IPlayerInput> playerInput,
-    std::shared_ptr<sf::RenderWindow> window,
+    std::shared_ptr<render_target::IRenderTarget> renderTarget,
     std::shared_ptr<view::IDrawableComposite> compositeView) :
     gameModel_(gameModel)
     , playerInput_(playerInput)
-    , window_(window)
+    , renderTarget_(renderTarget)
     , compositeView_(compositeView)
-{ updateScoreView_(); }
+    , fieldView_(compositeView->handle<view::DrawableGridCanvas>("grid"))
+    , scoreView_(compositeView->handle<view::DrawableText>("score_text"))
+    , paintedScore_(gameModel->score())
+{
+    using tetris_game_model::BlockType;
+    // indexed by block type, so snapshot rows are painted as they are
+    std::array<sf::Color, static_cast<std::size_t>(BlockType::GHOST) + 1> palette;
+    for (std::size_t i = 0; i < palette.size(); ++i) {
+        palette[i] = tetrominoBlockColor_(static_cast<BlockType>(i));
+    }
+    assert(fieldView_);
+    fieldView_->setPalette(palette);
+    updateScoreView_(paintedScore_);
+}
+
+TetrisGameController::~TetrisGameController() {
+    stopRenderThread_();
+}
 
 void TetrisGameController::registerAsObserver() {
     using namespace observer_n_subject;
 
+    // the render thread paints from the snapshots
+    gameModel_->setSnapshotPublishing(true);
     gameModel_->attach(getThis(), EventType::GAME_FIELD_UPDATE);
     gameModel_->attach(getThis(), EventType::GAME_SCORE_UPDATE);
     gameModel_->attach(getThis(), EventType::GAME_FINISH);
@@ -36,64 +84,155 @@ void TetrisGameController::registerAsObserver() {
 
 void TetrisGameController::runModel(
     std::mutex& modelMut, std::atomic_bool& isGameRun, std::atomic_bool& isGamePause) {
+    startRenderThread_();
     gameLoop_(modelMut, isGameRun, isGamePause);
+    stopRenderThread_();
 } 
 
 std::shared_ptr<TetrisGameController> TetrisGameController::getThis() {
     return shared_from_this();
 }
 
+void TetrisGameController::setLoopMode(
+    LoopMode mode, std::chrono::milliseconds inputPollPeriod) {
+    loopMode_ = mode;
+    inputPollPeriod_ = inputPollPeriod;
+}
+
+LoopMode TetrisGameController::loopMode() const {
+    return loopMode_;
+}
+
+LoopStats TetrisGameController::loopStats() const {
+    return {
+        wakeUps_.load(std::memory_order_relaxed),
+        eventsHandled_.load(std::memory_order_relaxed),
+        eventsDropped_.load(std::memory_order_relaxed),
+        std::chrono::nanoseconds(loopCpuTimeNs_.load(std::memory_order_relaxed))
+    };
+}
+
+void TetrisGameController::setFrameRateLimit(unsigned fps) {
+    minFramePeriod_ = fps 
+        ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)) / fps
+        : std::chrono::steady_clock::duration::zero();
+}
+
+FrameStats TetrisGameController::frameStats() const {
+    return {
+        redrawRequests_.load(std::memory_order_relaxed),
+        framesPresented_.load(std::memory_order_relaxed),
+        framesCoalesced_.load(std::memory_order_relaxed),
+        framesDropped_.load(std::memory_order_relaxed),
+        std::chrono::nanoseconds(lastLatencyNs_.load(std::memory_order_relaxed)),
+        std::chrono::nanoseconds(maxLatencyNs_.load(std::memory_order_relaxed)),
+        std::chrono::nanoseconds(totalLatencyNs_.load(std::memory_order_relaxed))
+    };
+}
+
+void TetrisGameController::setPerfStats(std::shared_ptr<perf_stats::PerfStats> stats) {
+    perfStats_ = std::move(stats);
+}
+
 void TetrisGameController::gameLoop_(
+    std::mutex& modelMut, std::atomic_bool& isGameRun, std::atomic_bool& isGamePause) {
+    loopStartCpuTime_ = threadCpuTime();
+    switch (loopMode_) {
+        case LoopMode::SPIN:
+            spinGameLoop_(modelMut, isGameRun, isGamePause);
+            break;
+        case LoopMode::BLOCKING:
+            blockingGameLoop_(modelMut, isGameRun, isGamePause);
+            break;
+    }
+    auto spent = threadCpuTime() - loopStartCpuTime_;
+    loopCpuTimeNs_.store(spent.count(), std::memory_order_relaxed);
+}
+
+void TetrisGameController::spinGameLoop_(
     std::mutex& modelMut, std::atomic_bool& isGameRun, std::atomic_bool& isGamePause) {
     observer_n_subject::EventType event;
-    while (isGameRun) {
+    while (isGameRunning_(isGameRun)) {
         while (!eventQueue_.tryPop(event)) {
+            if (!isGameRunning_(isGameRun)) return;
             playerInput_->pollInput();
             std::this_thread::yield();
+            countWakeUp_();
+        }
+        handleEvent_(modelMut, isGameRun, isGamePause, event);
+    }
+}
+
+// input comes from the window or the terminal, polled on this thread, so
+// the wait on the queue is bounded by inputPollPeriod_
+void TetrisGameController::blockingGameLoop_(
+    std::mutex& modelMut, std::atomic_bool& isGameRun, std::atomic_bool& isGamePause) {
+    observer_n_subject::EventType event;
+    while (isGameRunning_(isGameRun)) {
+        if (!eventQueue_.tryPop(event)) {
+            playerInput_->pollInput();
+            if (!eventQueue_.tryPop(event)) {
+                bool hasEvent = eventQueue_.waitPopFor(event, inputPollPeriod_);
+                countWakeUp_();
+                if (!hasEvent) continue;
+            }
         }
         handleEvent_(modelMut, isGameRun, isGamePause, event);
     }
 }
 
+bool TetrisGameController::isGameRunning_(std::atomic_bool& isGameRun) {
+    if (isGameFinished_.load(std::memory_order_acquire)) {
+        isGameRun = false;
+    }
+    return isGameRun;
+}
+
+void TetrisGameController::countWakeUp_() {
+    wakeUps_.fetch_add(1, std::memory_order_relaxed);
+    auto spent = threadCpuTime() - loopStartCpuTime_;
+    loopCpuTimeNs_.store(spent.count(), std::memory_order_relaxed);
+}
+
+// runs func under modelMut, timing the wait and the call if sampling
+template <typename F>
+void TetrisGameController::withModel_(std::mutex& modelMut, F&& func) {
+    perf_stats::withSampledLock(perfStats_.get(), modelMut, std::forward<F>(func));
+}
+
 void TetrisGameController::handleEvent_(
     std::mutex& modelMut, std::atomic_bool& isGameRun, 
     std::atomic_bool& isGamePause, observer_n_subject::EventType event) {
     using namespace observer_n_subject;
+    eventsHandled_.fetch_add(1, std::memory_order_relaxed);
+    if (perfStats_) {
+        perfStats_->queueDepth.record(static_cast<std::int64_t>(eventQueue_.sizeApprox()));
+    }
     switch (event) {
-        case EventType::GAME_FIELD_UPDATE: {
-            std::lock_guard<std::mutex> lk{modelMut};
-            updateFieldView_();
-            redrawWindowNDisplay_();
-            break;
-        } 
+        case EventType::GAME_FIELD_UPDATE:
         case EventType::GAME_SCORE_UPDATE: {
-            std::lock_guard<std::mutex> lk{modelMut};
-            updateScoreView_();
-            redrawWindowNDisplay_();
+            // update() hands these to the render thread
             break;
         }
         case EventType::GAME_FINISH: {
+            // only wakes the loop, isGameFinished_ is already set
             isGameRun = false;
             break;
         } 
         case EventType::USER_ASKED_LEFT: {
-            std::lock_guard<std::mutex> lk{modelMut};
-            gameModel_->moveLeftTetromino();
+            withModel_(modelMut, [this] { gameModel_->moveLeftTetromino(); });
             break;
         } 
         case EventType::USER_ASKED_RIGHT: {
-            std::lock_guard<std::mutex> lk{modelMut};
-            gameModel_->moveRightTetromino();
+            withModel_(modelMut, [this] { gameModel_->moveRightTetromino(); });
             break;
         } 
         case EventType::USER_ASKED_DOWN: {
-            std::lock_guard<std::mutex> lk{modelMut};
-            gameModel_->updateModel();
+            withModel_(modelMut, [this] { gameModel_->updateModel(); });
             break;
         }
         case EventType::USER_ASKED_ROTATE_RIGHT: {
-            std::lock_guard<std::mutex> lk{modelMut};
-            gameModel_->rotateRightTetromino();
+            withModel_(modelMut, [this] { gameModel_->rotateRightTetromino(); });
             break;
         } 
         case EventType::USER_ASKED_CLOSE_GAME: {
@@ -108,36 +247,168 @@ void TetrisGameController::handleEvent_(
     }
 }
 
-void TetrisGameController::updateScoreView_() {
-    std::stringstream ss;
-    ss << "Your Score: ";
-    ss << gameModel_->score();
-    auto textView = std::dynamic_pointer_cast<view::DrawableText>(
-        compositeView_->getComponent("score_text")
-    );
-    assert(textView);
-    textView->setText(ss.str());
+// keeps the earliest arrival until a frame answers it
+void TetrisGameController::markInput_() {
+    if (!perfStats_) return;
+    std::int64_t none = 0;
+    pendingInputNs_.compare_exchange_strong(
+        none, sinceEpochNs(std::chrono::steady_clock::now()), 
+        std::memory_order_relaxed);
 }
 
-void TetrisGameController::updateFieldView_() {
-    auto fieldView = std::dynamic_pointer_cast<view::DrawableGridCanvas>(
-        compositeView_->getComponent("grid")
-    );
-    assert(fieldView);
-    fieldView->clear();
-    decltype(auto) field = gameModel_->field();
-    for (std::size_t i = 0; i < gameModel_->fieldHeight(); ++i) {
-        for (std::size_t j = 0; j < gameModel_->fieldWidth(); ++j) {
-            auto color = tetrominoBlockColor_(field[i][j]);
-            fieldView->paintCell({j, i}, color);
+// called by the model's threads, takes a lock only to wake an idle
+// render thread, never waits for a frame
+void TetrisGameController::requestFrame_() {
+    redrawRequests_.fetch_add(1, std::memory_order_relaxed);
+    frameRequests_.fetch_add(1, std::memory_order_release);
+    // pairs with the fence in waitFrameRequest_(), as in LockFreeQueue
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (isRenderSleeping_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lk{renderMut_};
+        renderCv_.notify_one();
+    }
+}
+
+void TetrisGameController::waitFrameRequest_(std::uint64_t seenRequests) {
+    // the stop request may have been taken for a frame request already
+    auto isRequested = [&] {
+        return frameRequests_.load(std::memory_order_acquire) != seenRequests
+               || isRenderStopped_;
+    };
+    if (isRequested()) return;
+    std::unique_lock<std::mutex> lk{renderMut_};
+    isRenderSleeping_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    renderCv_.wait(lk, isRequested);
+    isRenderSleeping_.store(false, std::memory_order_relaxed);
+}
+
+void TetrisGameController::startRenderThread_() {
+    isRenderStopped_ = false;
+    // the render thread makes it current for itself
+    renderTarget_->setActive(false);
+    renderThread_ = std::thread([this] { renderLoop_(); });
+}
+
+void TetrisGameController::stopRenderThread_() {
+    if (!renderThread_.joinable()) return;
+    isRenderStopped_ = true;
+    frameRequests_.fetch_add(1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+        std::lock_guard<std::mutex> lk{renderMut_};
+        renderCv_.notify_one();
+    }
+    renderThread_.join();
+    renderTarget_->setActive(true);
+}
+
+// draws the newest snapshot after each batch of requests, whatever came
+// in while a frame was drawn or paced goes into the next one
+void TetrisGameController::renderLoop_() {
+    renderTarget_->setActive(true);
+    std::uint64_t seenRequests = 0;
+    // redraw requests up to the last batch taken for a frame
+    std::uint64_t takenRequests = 0;
+    auto takeRequests = [&] {
+        auto requests = redrawRequests_.load(std::memory_order_relaxed);
+        auto batch = requests - takenRequests;
+        takenRequests = requests;
+        return batch;
+    };
+    auto nextFrameTime = std::chrono::steady_clock::now();
+    for (;;) {
+        waitFrameRequest_(seenRequests);
+        if (isRenderStopped_) break;
+        std::this_thread::sleep_until(nextFrameTime);
+        seenRequests = frameRequests_.load(std::memory_order_acquire);
+        auto batch = takeRequests();
+        nextFrameTime = std::chrono::steady_clock::now() + minFramePeriod_;
+        countCoalesced_(batch, presentFrame_());
+    }
+    // e.g. the last piece before GAME_FINISH
+    auto batch = takeRequests();
+    countCoalesced_(batch, presentFrame_());
+    renderTarget_->setActive(false);
+}
+
+// a batch shares one frame; it shares the previous one if its snapshot
+// was published while that frame was drawn
+void TetrisGameController::countCoalesced_(std::uint64_t requests, bool isPresented) {
+    std::uint64_t own = isPresented ? 1 : 0;
+    if (requests > own) {
+        framesCoalesced_.fetch_add(requests - own, std::memory_order_relaxed);
+    }
+}
+
+// false if the newest snapshot is already on the screen
+bool TetrisGameController::presentFrame_() {
+    auto start = std::chrono::steady_clock::now();
+    const auto& snapshot = gameModel_->latestSnapshot();
+    if (snapshot.sequence == paintedSequence_) return false;
+    if (paintedSequence_ != 0) {
+        framesDropped_.fetch_add(
+            snapshot.sequence - paintedSequence_ - 1, std::memory_order_relaxed);
+    }
+    updateFieldView_(snapshot, paintedSequence_);
+    paintedSequence_ = snapshot.sequence;
+    if (snapshot.score != paintedScore_) {
+        paintedScore_ = snapshot.score;
+        updateScoreView_(paintedScore_);
+    }
+    redrawWindowNDisplay_();
+
+    auto now = std::chrono::steady_clock::now();
+    if (perfStats_) {
+        perfStats_->frameTime.record(now - start);
+        // a snapshot published after the input most likely shows it
+        auto input = pendingInputNs_.load(std::memory_order_relaxed);
+        if (input && sinceEpochNs(snapshot.publishedAt) >= input
+            && pendingInputNs_.compare_exchange_strong(input, 0, std::memory_order_relaxed)) {
+            perfStats_->inputLatency.record(sinceEpochNs(now) - input);
         }
     }
+    std::int64_t latency = (now - snapshot.publishedAt).count();
+    framesPresented_.fetch_add(1, std::memory_order_relaxed);
+    lastLatencyNs_.store(latency, std::memory_order_relaxed);
+    totalLatencyNs_.fetch_add(latency, std::memory_order_relaxed);
+    if (latency > maxLatencyNs_.load(std::memory_order_relaxed)) {
+        maxLatencyNs_.store(latency, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void TetrisGameController::updateScoreView_(int score) {
+    static constexpr std::string_view prefix = "Your Score: ";
+    std::array<char, prefix.size() + 16> buf;
+    auto digits = std::copy(prefix.begin(), prefix.end(), buf.begin());
+    auto [end, ec] = std::to_chars(digits, buf.data() + buf.size(), score);
+    assert(scoreView_);
+    scoreView_->setText({buf.data(), end});
+}
+
+// the rows the snapshot changed are enough if the canvas shows the
+// snapshot it was made from or a later one; otherwise every row is
+// painted and the canvas skips those that did not change
+void TetrisGameController::updateFieldView_(
+    const tetris_game_model::FieldSnapshot& snapshot, std::uint64_t paintedSequence) {
+    auto* fieldView = fieldView_.get();
+    assert(fieldView);
+    std::span<const tetris_game_model::BlockType> cells = snapshot.cells;
+    auto paintRow = [&](std::size_t y) {
+        fieldView->paintRow(y, cells.subspan(y * snapshot.width, snapshot.width));
+    };
+    if (snapshot.baseSequence <= paintedSequence) {
+        for (auto y : snapshot.dirtyRows) paintRow(y);
+        return;
+    }
+    for (std::size_t y = 0; y < snapshot.height; ++y) paintRow(y);
 }
 
 void TetrisGameController::redrawWindowNDisplay_() {
-    window_->clear(sf::Color::White);
-    compositeView_->draw(*window_, {0, 0});
-    window_->display();
+    renderTarget_->clear(sf::Color::White);
+    compositeView_->draw(*renderTarget_, {0, 0});
+    renderTarget_->display();
 }
 
 sf::Color TetrisGameController::tetrominoBlockColor_(tetris_game_model::BlockType block) const {
@@ -158,7 +429,25 @@ sf::Color TetrisGameController::tetrominoBlockColor_(tetris_game_model::BlockTyp
 
 void TetrisGameController::update(
     observer_n_subject::ISubject& subject, observer_n_subject::EventType event) {
-    eventQueue_.push(event);
+    using namespace observer_n_subject;
+    if (event == EventType::GAME_FIELD_UPDATE || event == EventType::GAME_SCORE_UPDATE) {
+        requestFrame_();
+        return;
+    }
+    // the loop's thread raises it from handleEvent_(), so nothing here may
+    // wait for the loop to make room in the queue
+    if (event == EventType::GAME_FINISH) {
+        isGameFinished_.store(true, std::memory_order_release);
+        eventQueue_.tryPush(event);
+        return;
+    }
+    if (event == EventType::USER_ASKED_LEFT || event == EventType::USER_ASKED_RIGHT
+        || event == EventType::USER_ASKED_DOWN || event == EventType::USER_ASKED_ROTATE_RIGHT) {
+        markInput_();
+    }
+    if (!eventQueue_.tryPush(event)) {
+        eventsDropped_.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
 } // namespace tetris_game_controller
\ No newline at end of file
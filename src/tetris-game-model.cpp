@@ -1,37 +1,151 @@
 #include "../include/tetris-game-model.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <vector>
 #include <iostream>
 
 #include "../include/tetromino-movement.hpp"
 #include "../include/score-strategy.hpp"
+#include "../include/triple-buffer.hpp"
+#include "../include/zobrist.hpp"
 
 using observer_n_subject::IObserver;
 using observer_n_subject::ISubject;
 using observer_n_subject::EventType;
 
-namespace {
-    // UB if row >= m.size() or row <= 0
-    template <typename... Ts, typename... Us>
-    void lowerLayersUnderRow(std::vector<std::vector<Ts...>, Us...>& m, int row) {
-        for (auto i = row - 1; i > 0; --i) {
-            m[i + 1] = m[i];
+namespace tetris_game_model {
+
+// ##################################################
+// FieldChangeSet
+FieldChangeSet::FieldChangeSet(std::size_t fieldWidth, std::size_t fieldHeight) :
+    fieldWidth_(fieldWidth)
+    , fieldHeight_(fieldHeight)
+    , dirty_((fieldWidth * fieldHeight + WORD_BITS - 1) / WORD_BITS, 0)
+    , isRowDirty_(fieldHeight, 0)
+{
+    // marking never allocates
+    dirtyRows_.reserve(fieldHeight);
+}
+
+void FieldChangeSet::markDirty(std::size_t x, std::size_t y) {
+    auto cell = y * fieldWidth_ + x;
+    dirty_[cell / WORD_BITS] |= word_t{1} << (cell % WORD_BITS);
+    if (!isRowDirty_[y]) {
+        isRowDirty_[y] = 1;
+        dirtyRows_.push_back(y);
+    }
+}
+
+void FieldChangeSet::markRowsDirty(std::size_t fromRow, std::size_t toRow) {
+    auto first = fromRow * fieldWidth_;
+    auto last = toRow * fieldWidth_;
+    if (first >= last) return;
+    for (auto cell = first; cell < last;) {
+        auto bit = cell % WORD_BITS;
+        auto count = std::min(WORD_BITS - bit, last - cell);
+        auto bits = count == WORD_BITS ? ~word_t{0} : ((word_t{1} << count) - 1);
+        dirty_[cell / WORD_BITS] |= bits << bit;
+        cell += count;
+    }
+    for (auto y = fromRow; y < toRow; ++y) {
+        if (!isRowDirty_[y]) {
+            isRowDirty_[y] = 1;
+            dirtyRows_.push_back(y);
         }
     }
-} // namespace
+}
 
-namespace tetris_game_model {
+void FieldChangeSet::markAllDirty() {
+    markRowsDirty(0, fieldHeight_);
+}
+
+void FieldChangeSet::addDeletedRows(const std::vector<std::size_t>& rows) {
+    deletedRows_.insert(deletedRows_.end(), rows.begin(), rows.end());
+}
+
+// only the words of changed rows can have bits set
+void FieldChangeSet::reset() {
+    for (auto y : dirtyRows_) {
+        auto first = y * fieldWidth_ / WORD_BITS;
+        auto last = ((y + 1) * fieldWidth_ - 1) / WORD_BITS;
+        std::fill(dirty_.begin() + first, dirty_.begin() + last + 1, 0);
+        isRowDirty_[y] = 0;
+    }
+    dirtyRows_.clear();
+    deletedRows_.clear();
+}
+
+bool FieldChangeSet::empty() const {
+    return dirtyRows_.empty();
+}
+
+const std::vector<std::size_t>& FieldChangeSet::dirtyRows() const {
+    return dirtyRows_;
+}
+
+const std::vector<std::size_t>& FieldChangeSet::deletedRows() const {
+    return deletedRows_;
+}
 
 // ##################################################
 // TetrisGameModelImpl
+namespace {
+    // the locked blocks of a field row as if it were row y
+    std::uint64_t lockedRowKey(const std::vector<BlockType>& row, std::size_t y) {
+        std::uint64_t key = 0;
+        for (std::size_t x = 0; x < row.size(); ++x) {
+            if (row[x] != BlockType::VOID && row[x] != BlockType::GHOST) {
+                key ^= zobrist::blockKey(x, y);
+            }
+        }
+        return key;
+    }
+
+    // rows a buffer of the snapshots misses, each listed once
+    class RowSet {
+    public:
+        explicit RowSet(std::size_t height) : 
+            isListed_(height, 0) 
+        {
+            rows_.reserve(height);
+        }
+
+        void add(std::size_t y) {
+            if (isListed_[y]) return;
+            isListed_[y] = 1;
+            rows_.push_back(y);
+        }
+
+        void addAll() {
+            for (std::size_t y = 0; y < isListed_.size(); ++y) add(y);
+        }
+
+        void clear() {
+            for (auto y : rows_) isListed_[y] = 0;
+            rows_.clear();
+        }
+
+        const std::vector<std::size_t>& rows() const {
+            return rows_;
+        }
+
+    private:
+        std::vector<std::uint8_t> isListed_;
+        std::vector<std::size_t> rows_;
+    };
+} // namespace
+
 class TetrisGameModelImpl__ final : public observer_n_subject::SubjectImpl { 
 public:
     TetrisGameModelImpl__(
         std::size_t fieldWidth, std::size_t fieldHeight,
         std::unique_ptr<tetromino_movement::TetrominoMovement> movementImpl,
-        std::unique_ptr<score_strategy::ScoreStrategy> scoreStrategy);
+        std::unique_ptr<score_strategy::ScoreStrategy> scoreStrategy,
+        std::optional<tetrominoes::TetrominoGenerator> generator);
 
     using field_ptr_t = std::shared_ptr<std::vector<std::vector<BlockType>>>;
 
@@ -42,64 +156,130 @@ public:
     int score() const;
     std::size_t fieldWidth() const; 
     std::size_t fieldHeight() const;
+    bool isGameFinished() const;
+    const tetrominoes::Tetromino& currentTetromino() const;
+    std::uint64_t piecesLocked() const;
+    std::uint64_t linesCleared() const;
+    std::uint64_t lockedFieldHash() const;
+    std::size_t stackTop() const;
 
     bool rotateRightTetromino();     
     bool moveLeftTetromino();
     bool moveRightTetromino();
+    bool hardDropTetromino();
+    const std::vector<std::size_t>& deletedRows() const;
+    const FieldChangeSet& changeSet() const;
+    void setSnapshotPublishing(bool isPublishing);
+    bool isSnapshotPublishing() const;
+    const FieldSnapshot& latestSnapshot();
+    SnapshotStats snapshotStats() const;
     
+    void publishSnapshot_();
     void fireFieldUpdate_();
     void fireScoreUpdate_();
     void fireGameFinish_();
 
+    void lockTetromino_();
     int deleteFullLines_();
     void deleteFullLinesNUpdateScore_();
     bool setNextTetromino_();
 
 private:
     field_ptr_t field_;
+    std::shared_ptr<FieldChangeSet> changeSet_;
+    // locked blocks in each row
+    std::vector<std::size_t> rowFill_;
+    // no locked blocks above this row
+    std::size_t stackTop_;
+    std::vector<std::size_t> deletedRows_;
+    // zobrist keys of the locked blocks, updated where they are locked
+    // and where lines are deleted
+    std::uint64_t lockedHash_ = 0;
     int score_ = 0;
+    bool isGameFinished_ = false;
+    std::uint64_t piecesLocked_ = 0;
+    std::uint64_t linesCleared_ = 0;
+    // std::random_device seeded tetrominoes without one
+    std::optional<tetrominoes::TetrominoGenerator> generator_;
     std::unique_ptr<tetromino_movement::TetrominoMovement> movementImpl_;
     std::unique_ptr<score_strategy::ScoreStrategy> scoreStrategy_;
+
+    bool isPublishing_ = false;
+    triple_buffer::TripleBuffer<FieldSnapshot> snapshots_;
+    // per buffer, the rows changed since it was last written
+    std::vector<RowSet> staleRows_;
+    std::uint64_t snapshotSequence_ = 0;
+    std::atomic<std::uint64_t> published_ = 0;
+    std::atomic<std::int64_t> lastPublishCostNs_ = 0;
+    std::atomic<std::int64_t> maxPublishCostNs_ = 0;
+    std::atomic<std::int64_t> totalPublishCostNs_ = 0;
 };
 
 // definitions
 TetrisGameModelImpl__::TetrisGameModelImpl__(
     std::size_t fieldWidth, std::size_t fieldHeight,
     std::unique_ptr<tetromino_movement::TetrominoMovement> movementImpl,
-    std::unique_ptr<score_strategy::ScoreStrategy> scoreStrategy) 
+    std::unique_ptr<score_strategy::ScoreStrategy> scoreStrategy,
+    std::optional<tetrominoes::TetrominoGenerator> generator) :
+    generator_(generator)
 {
     movementImpl_ = std::move(movementImpl);
     scoreStrategy_ = std::move(scoreStrategy);
     field_ = std::make_shared<std::vector<std::vector<BlockType>>>(
         fieldHeight, std::vector<BlockType>(fieldWidth, BlockType::VOID));
+    changeSet_ = std::make_shared<FieldChangeSet>(fieldWidth, fieldHeight);
+    // one per buffer of the snapshots
+    staleRows_.assign(3, RowSet(fieldHeight));
+    rowFill_.assign(fieldHeight, 0);
+    stackTop_ = fieldHeight;
+    deletedRows_.reserve(tetrominoes::BLOCKS_COUNT);
     movementImpl_->setField(field_);
-    setNextTetromino_();
+    isGameFinished_ = !setNextTetromino_();
 }
 
 void TetrisGameModelImpl__::updateModel() {
+    if (isGameFinished_) {
+        return;
+    }
     if (movementImpl_->moveDown()) {
     } else {
-        deleteFullLinesNUpdateScore_();
-        if (!setNextTetromino_())  {
-            fireGameFinish_();
-        }
+        lockTetromino_();
+    }
+    fireFieldUpdate_();
+}
+
+bool TetrisGameModelImpl__::hardDropTetromino() {
+    if (isGameFinished_) {
+        return false;
     }
+    bool suc = movementImpl_->hardDrop();
+    lockTetromino_();
     fireFieldUpdate_();
+    return suc;
 }
 
 bool TetrisGameModelImpl__::rotateRightTetromino() {
+    if (isGameFinished_) {
+        return false;
+    }
     bool suc = movementImpl_->rotateRight();
     if (suc) fireFieldUpdate_();
     return suc;
 }    
 
 bool TetrisGameModelImpl__::moveLeftTetromino() {
+    if (isGameFinished_) {
+        return false;
+    }
     bool suc = movementImpl_->moveLeft();
     if (suc) fireFieldUpdate_();
     return suc;
 }
 
 bool TetrisGameModelImpl__::moveRightTetromino() {
+    if (isGameFinished_) {
+        return false;
+    }
     bool suc = movementImpl_->moveRight();
     if (suc) fireFieldUpdate_();
     return suc;
@@ -113,6 +293,43 @@ int TetrisGameModelImpl__::score() const {
     return score_;
 }
 
+const std::vector<std::size_t>& TetrisGameModelImpl__::deletedRows() const {
+    return deletedRows_;
+}
+
+const FieldChangeSet& TetrisGameModelImpl__::changeSet() const {
+    return *changeSet_;
+}
+
+// changes are only tracked for the snapshots; the buffers may be
+// anything older by now, each is rewritten in full
+void TetrisGameModelImpl__::setSnapshotPublishing(bool isPublishing) {
+    isPublishing_ = isPublishing;
+    movementImpl_->setChangeSet(isPublishing_ ? changeSet_ : nullptr);
+    changeSet_->reset();
+    if (!isPublishing_) return;
+    for (auto& stale : staleRows_) stale.addAll();
+    publishSnapshot_();
+}
+
+bool TetrisGameModelImpl__::isSnapshotPublishing() const {
+    return isPublishing_;
+}
+
+const FieldSnapshot& TetrisGameModelImpl__::latestSnapshot() {
+    snapshots_.acquire();
+    return snapshots_.front();
+}
+
+SnapshotStats TetrisGameModelImpl__::snapshotStats() const {
+    return {
+        published_.load(std::memory_order_relaxed),
+        std::chrono::nanoseconds(lastPublishCostNs_.load(std::memory_order_relaxed)),
+        std::chrono::nanoseconds(maxPublishCostNs_.load(std::memory_order_relaxed)),
+        std::chrono::nanoseconds(totalPublishCostNs_.load(std::memory_order_relaxed))
+    };
+}
+
 std::size_t TetrisGameModelImpl__::fieldWidth() const {
     return field_->at(0).size();
 } 
@@ -120,12 +337,73 @@ std::size_t TetrisGameModelImpl__::fieldHeight() const {
     return field_->size();
 }
 
+bool TetrisGameModelImpl__::isGameFinished() const {
+    return isGameFinished_;
+}
+
+const tetrominoes::Tetromino& TetrisGameModelImpl__::currentTetromino() const {
+    return movementImpl_->tetromino();
+}
+
+std::uint64_t TetrisGameModelImpl__::piecesLocked() const {
+    return piecesLocked_;
+}
+
+std::uint64_t TetrisGameModelImpl__::linesCleared() const {
+    return linesCleared_;
+}
+
+std::uint64_t TetrisGameModelImpl__::lockedFieldHash() const {
+    return lockedHash_;
+}
+
+std::size_t TetrisGameModelImpl__::stackTop() const {
+    return stackTop_;
+}
+
+
+// the back buffer holds an older snapshot, only the rows changed since
+// then are copied over it
+void TetrisGameModelImpl__::publishSnapshot_() {
+    auto start = std::chrono::steady_clock::now();
+    for (auto y : changeSet_->dirtyRows()) {
+        for (auto& stale : staleRows_) stale.add(y);
+    }
+    changeSet_->reset();
+
+    auto& stale = staleRows_[snapshots_.backIndex()];
+    auto& snapshot = snapshots_.back();
+    const auto& f = *field_;
+    snapshot.width = fieldWidth();
+    snapshot.height = fieldHeight();
+    snapshot.cells.resize(snapshot.width * snapshot.height);
+    snapshot.dirtyRows.assign(stale.rows().begin(), stale.rows().end());
+    for (auto y : stale.rows()) {
+        std::copy(f[y].begin(), f[y].end(), snapshot.cells.begin() + y * snapshot.width);
+    }
+    stale.clear();
+    snapshot.baseSequence = snapshot.sequence;
+    snapshot.score = score_;
+    snapshot.sequence = ++snapshotSequence_;
+    snapshot.publishedAt = std::chrono::steady_clock::now();
+    snapshots_.publish();
+
+    std::int64_t cost = (std::chrono::steady_clock::now() - start).count();
+    published_.fetch_add(1, std::memory_order_relaxed);
+    lastPublishCostNs_.store(cost, std::memory_order_relaxed);
+    totalPublishCostNs_.fetch_add(cost, std::memory_order_relaxed);
+    if (cost > maxPublishCostNs_.load(std::memory_order_relaxed)) {
+        maxPublishCostNs_.store(cost, std::memory_order_relaxed);
+    }
+}
 
 void TetrisGameModelImpl__::fireFieldUpdate_() {
+    if (isPublishing_) publishSnapshot_();
     notify(observer_n_subject::EventType::GAME_FIELD_UPDATE);
 }
 
 void TetrisGameModelImpl__::fireScoreUpdate_() {
+    if (isPublishing_) publishSnapshot_();
     notify(observer_n_subject::EventType::GAME_SCORE_UPDATE);
 }
 
@@ -133,23 +411,67 @@ void TetrisGameModelImpl__::fireGameFinish_() {
     notify(observer_n_subject::EventType::GAME_FINISH);
 }
 
+void TetrisGameModelImpl__::lockTetromino_() {
+    movementImpl_->lockTetromino();
+    ++piecesLocked_;
+    const auto& tetromino = movementImpl_->tetromino();
+    for (auto b : tetromino.shape()) {
+        ++rowFill_[b.second];
+        lockedHash_ ^= zobrist::blockKey(b.first, b.second);
+    }
+    stackTop_ = std::min<std::size_t>(stackTop_, tetromino.highestPointOnY());
+
+    deleteFullLinesNUpdateScore_();
+    if (!setNextTetromino_())  {
+        isGameFinished_ = true;
+        fireGameFinish_();
+    }
+}
+
 int TetrisGameModelImpl__::deleteFullLines_() {
-    decltype(auto) f = *field_;
+    // only rows of the locked tetromino could have been filled up
+    const auto& tetromino = movementImpl_->tetromino();
+    deletedRows_.clear();
+    for (int y = tetromino.highestPointOnY(); y <= tetromino.lowestPointOnY(); ++y) {
+        if (rowFill_[y] == fieldWidth()) {
+            deletedRows_.push_back(y);
+        }
+    }
+    if (deletedRows_.empty()) {
+        return 0;
+    }
 
-    auto isEmptyBlock = [] (auto b) {
-        return b == BlockType::VOID || b == BlockType::GHOST;
-    };
-    
-    int countLines = 0;
-    int sz = f.size();
-    for (int i = sz - 1; i >= 0; --i) {
-        while (std::find_if(f[i].begin(), f[i].end(), isEmptyBlock) == f[i].end()) {
-            lowerLayersUnderRow(f, i);
-            ++countLines;
+    // stable compaction from the lowest deleted row up to the stack top,
+    // rows are swapped so the deleted ones end up on top for reuse
+    decltype(auto) f = *field_;
+    auto deleted = deletedRows_.rbegin();
+    std::size_t write = deletedRows_.back();
+    for (std::size_t read = write + 1; read-- > stackTop_;) {
+        if (deleted != deletedRows_.rend() && *deleted == read) {
+            lockedHash_ ^= lockedRowKey(f[read], read);
+            ++deleted;
+            continue;
         }
+        if (write != read) {
+            lockedHash_ ^= lockedRowKey(f[read], read) ^ lockedRowKey(f[read], write);
+            std::swap(f[write], f[read]);
+            std::swap(rowFill_[write], rowFill_[read]);
+        }
+        --write;
+    }
+    for (auto y = stackTop_; y < stackTop_ + deletedRows_.size(); ++y) {
+        std::fill(f[y].begin(), f[y].end(), BlockType::VOID);
+        rowFill_[y] = 0;
     }
+    if (isPublishing_) {
+        changeSet_->markRowsDirty(stackTop_, deletedRows_.back() + 1);
+        changeSet_->addDeletedRows(deletedRows_);
+    }
+    stackTop_ += deletedRows_.size();
+    linesCleared_ += deletedRows_.size();
 
-    return countLines;
+    movementImpl_->linesDeleted(deletedRows_);
+    return static_cast<int>(deletedRows_.size());
 }
 
 void TetrisGameModelImpl__::deleteFullLinesNUpdateScore_() {
@@ -159,7 +481,7 @@ void TetrisGameModelImpl__::deleteFullLinesNUpdateScore_() {
 }
 
 bool TetrisGameModelImpl__::setNextTetromino_() {
-    auto nextTetromino = tetrominoes::getRandomTetromino();
+    auto nextTetromino = generator_ ? generator_->next() : tetrominoes::getRandomTetromino();
     for (int i = 0; i < fieldWidth() / 2; ++i) {
         nextTetromino.moveRightOneSquare();
     }
@@ -169,18 +491,42 @@ bool TetrisGameModelImpl__::setNextTetromino_() {
 // ##################################################
 // TetrisGameModelImplDeleter
 void TetrisGameModelImplDeleter::operator()(TetrisGameModelImpl__* ptr) {
-    ptr->~TetrisGameModelImpl__();
+    delete ptr;
 } 
 
 // ##################################################
 // TetrisGameModel
+namespace {
+    std::unique_ptr<tetromino_movement::TetrominoMovement> 
+    makeMovementImpl(std::size_t fieldWidth) {
+        using namespace tetromino_movement;
+        if (fieldWidth <= BitboardTetrominoMovement::MAX_FIELD_WIDTH) {
+            return std::unique_ptr<BitboardTetrominoMovement>(
+                new BitboardTetrominoMovement());
+        }
+        return std::unique_ptr<TetrominoMovementWithGhostTetromino>(
+            new TetrominoMovementWithGhostTetromino());
+    }
+} // namespace
+
 TetrisGameModel::TetrisGameModel(std::size_t fieldWidth, std::size_t fieldHeight) 
     : impl_(new TetrisGameModelImpl__(
         fieldWidth, fieldHeight,
-        std::unique_ptr<tetromino_movement::TetrominoMovementWithGhostTetromino>(
-            new tetromino_movement::TetrominoMovementWithGhostTetromino()),
+        makeMovementImpl(fieldWidth),
         std::unique_ptr<score_strategy::ScoreStrategy>(
-            new score_strategy::SquareLineScoreStrategy())
+            new score_strategy::SquareLineScoreStrategy()),
+        std::nullopt
+    ))
+{}
+
+TetrisGameModel::TetrisGameModel(
+    std::size_t fieldWidth, std::size_t fieldHeight, std::uint64_t seed) 
+    : impl_(new TetrisGameModelImpl__(
+        fieldWidth, fieldHeight,
+        makeMovementImpl(fieldWidth),
+        std::unique_ptr<score_strategy::ScoreStrategy>(
+            new score_strategy::SquareLineScoreStrategy()),
+        tetrominoes::TetrominoGenerator(seed)
     ))
 {}
 
@@ -211,6 +557,30 @@ std::size_t TetrisGameModel::fieldHeight() const {
     return impl_->fieldHeight();
 }
 
+bool TetrisGameModel::isGameFinished() const {
+    return impl_->isGameFinished();
+}
+
+const tetrominoes::Tetromino& TetrisGameModel::currentTetromino() const {
+    return impl_->currentTetromino();
+}
+
+std::uint64_t TetrisGameModel::piecesLocked() const {
+    return impl_->piecesLocked();
+}
+
+std::uint64_t TetrisGameModel::linesCleared() const {
+    return impl_->linesCleared();
+}
+
+std::uint64_t TetrisGameModel::lockedFieldHash() const {
+    return impl_->lockedFieldHash();
+}
+
+std::size_t TetrisGameModel::stackTop() const {
+    return impl_->stackTop();
+}
+
 bool TetrisGameModel::rotateRightTetromino() {
     return impl_->rotateRightTetromino();
 }
@@ -223,4 +593,32 @@ bool TetrisGameModel::moveRightTetromino() {
     return impl_->moveRightTetromino();
 }
 
+bool TetrisGameModel::hardDropTetromino() {
+    return impl_->hardDropTetromino();
+}
+
+const std::vector<std::size_t>& TetrisGameModel::deletedRows() const {
+    return impl_->deletedRows();
+}
+
+const FieldChangeSet& TetrisGameModel::changeSet() const {
+    return impl_->changeSet();
+}
+
+void TetrisGameModel::setSnapshotPublishing(bool isPublishing) {
+    impl_->setSnapshotPublishing(isPublishing);
+}
+
+bool TetrisGameModel::isSnapshotPublishing() const {
+    return impl_->isSnapshotPublishing();
+}
+
+const FieldSnapshot& TetrisGameModel::latestSnapshot() {
+    return impl_->latestSnapshot();
+}
+
+SnapshotStats TetrisGameModel::snapshotStats() const {
+    return impl_->snapshotStats();
+}
+
 } // namespace tetris_game_model 
@@ -1,6 +1,9 @@
 #include "../include/tetromino-movement.hpp"
 
 
+#include <algorithm>
+#include <cassert>
+#include <climits>
 #include <unordered_map>
 
 namespace {
@@ -9,10 +12,29 @@ namespace {
     BlockType TetrominoTypeToBlockType(TetrominoType type) {
         return static_cast<BlockType>(type);
     }
+
+    bool isLockedBlock(BlockType block) {
+        return block != BlockType::VOID && block != BlockType::GHOST;
+    }
 } // namespace
 
 namespace tetromino_movement {
 
+// ##################################################
+// TetrominoMovement
+void TetrominoMovement::setChangeSet(
+    std::shared_ptr<tetris_game_model::FieldChangeSet> changeSet) {
+    changeSet_ = changeSet;
+}
+
+void TetrominoMovement::writeBlock_(
+    std::size_t x, std::size_t y, tetris_game_model::BlockType block) {
+    field_->operator[](y)[x] = block;
+    // a cell rewritten with what it held is marked too, it is rare and
+    // cheaper than reading the cell first
+    if (changeSet_) changeSet_->markDirty(x, y);
+}
+
 // ##################################################
 // TetrominoMovementWithGhostTetromino
 void TetrominoMovementWithGhostTetromino::setField(
@@ -65,6 +87,12 @@ bool TetrominoMovementWithGhostTetromino::rotateRight() {
 }
 
 bool TetrominoMovementWithGhostTetromino::setTetromino(tetrominoes::Tetromino tetromino) {
+    // a tetromino spawned onto locked blocks would overwrite them
+    for (const auto& p : tetromino.shape()) {
+        if (fieldHasBlockAt_(p.first, p.second)) {
+            return false;
+        }
+    }
     if (!canMoveDownTetromino_(tetromino)) {
         return false;
     }
@@ -74,6 +102,25 @@ bool TetrominoMovementWithGhostTetromino::setTetromino(tetrominoes::Tetromino te
     return true;
 }
 
+bool TetrominoMovementWithGhostTetromino::hardDrop() {
+    if (!canMoveDownTetromino_(curTetromino_)) {
+        return false;
+    }
+    deleteCurTetrominoOnField_();
+    curTetromino_ = curTetrominoGhost_;
+    setCurTetrominoOnField_();
+    updateTetrominoGhost_();
+    return true;
+}
+
+void TetrominoMovementWithGhostTetromino::lockTetromino() {
+    // the tetromino is already on the field
+}
+
+void TetrominoMovementWithGhostTetromino::linesDeleted(const std::vector<std::size_t>&) {
+    // nothing is cached besides the field
+}
+
 bool TetrominoMovementWithGhostTetromino::canMoveDownTetromino_(const tetrominoes::Tetromino& tetromino) const {
     for (const auto& p : tetromino.shape()) {
         if (p.second < fieldHeight_() - 1  &&
@@ -129,8 +176,7 @@ bool TetrominoMovementWithGhostTetromino::fieldHasBlockAt_(std::size_t x, std::s
             && block != tetris_game_model::BlockType::GHOST; 
 }
 void TetrominoMovementWithGhostTetromino::setBlockAt_(std::size_t x, std::size_t y, tetris_game_model::BlockType block) {
-    decltype(auto) blockAt = field_->operator[](y)[x];
-    blockAt = block;
+    writeBlock_(x, y, block);
 }
 
 void TetrominoMovementWithGhostTetromino::deleteBlockAt_(std::size_t x, std::size_t y) {
@@ -138,16 +184,14 @@ void TetrominoMovementWithGhostTetromino::deleteBlockAt_(std::size_t x, std::siz
 }
 
 void TetrominoMovementWithGhostTetromino::setGhostBlockAt_(std::size_t x, std::size_t y) {
-    decltype(auto) blockAt = field_->operator[](y)[x];
-    if (blockAt == BlockType::VOID) {
-        blockAt = BlockType::GHOST;
+    if (field_->operator[](y)[x] == BlockType::VOID) {
+        writeBlock_(x, y, BlockType::GHOST);
     }
 }
 
 void TetrominoMovementWithGhostTetromino::deleteGhostBlockAt_(std::size_t x, std::size_t y) {
-    decltype(auto) blockAt = field_->operator[](y)[x];
-    if (blockAt == BlockType::GHOST) {
-        blockAt = BlockType::VOID;
+    if (field_->operator[](y)[x] == BlockType::GHOST) {
+        writeBlock_(x, y, BlockType::VOID);
     }
 }
 
@@ -194,4 +238,257 @@ std::size_t TetrominoMovementWithGhostTetromino::fieldHeight_() const {
     return field_->size();
 }
 
+// ##################################################
+// BitboardTetrominoMovement
+void BitboardTetrominoMovement::setField(
+    std::shared_ptr<std::vector<std::vector<tetris_game_model::BlockType>>> field) {
+    field_ = field;
+    rebuildRows_();
+}
+
+bool BitboardTetrominoMovement::moveDown() {
+    if (!fits_(curMask_, 0, 1)) {
+        return false;
+    }
+    deleteCurTetrominoGhostOnField_();
+    deleteCurTetrominoOnField_();
+    curTetromino_.moveDownOneSquare();
+    ++curMask_.top;
+    setCurTetrominoOnField_();
+    updateTetrominoGhost_();
+    return true;
+}
+
+bool BitboardTetrominoMovement::moveLeft() {
+    if (!fits_(curMask_, -1, 0)) {
+        return false;
+    }
+    deleteCurTetrominoGhostOnField_();
+    deleteCurTetrominoOnField_();
+    curTetromino_.moveLeftOneSquare();
+    for (auto& row : curMask_.rows) row >>= 1;
+    setCurTetrominoOnField_();
+    updateTetrominoGhost_();
+    return true;
+}
+
+bool BitboardTetrominoMovement::moveRight() {
+    if (!fits_(curMask_, 1, 0)) {
+        return false;
+    }
+    deleteCurTetrominoGhostOnField_();
+    deleteCurTetrominoOnField_();
+    curTetromino_.moveRightOneSquare();
+    for (auto& row : curMask_.rows) row <<= 1;
+    setCurTetrominoOnField_();
+    updateTetrominoGhost_();
+    return true;
+}
+
+bool BitboardTetrominoMovement::rotateRight() {
+    auto rotated = curTetromino_;
+    rotated.rotateRigth();
+    // same bounds as TetrominoMovementWithGhostTetromino::canRotateRightTetromino_:
+    // the rotated piece may not reach the last column or the last row
+    if (rotated.leftmostPointOnX() < 0 || rotated.highestPointOnY() < 0 ||
+        rotated.rightmostPointOnX() >= static_cast<int>(fieldWidth_()) - 1 ||
+        rotated.lowestPointOnY() >= static_cast<int>(fieldHeight_()) - 1) 
+    {
+        return false;
+    }
+    auto rotatedMask = makeMask_(rotated);
+    if (!fits_(rotatedMask, 0, 0)) {
+        return false;
+    }
+    deleteCurTetrominoGhostOnField_();
+    deleteCurTetrominoOnField_();
+    curTetromino_ = rotated;
+    curMask_ = rotatedMask;
+    setCurTetrominoOnField_();
+    updateTetrominoGhost_();
+    return true;
+}
+
+bool BitboardTetrominoMovement::setTetromino(tetrominoes::Tetromino tetromino) {
+    auto mask = makeMask_(tetromino);
+    if (!fits_(mask, 0, 0) || !fits_(mask, 0, 1)) {
+        return false;
+    }
+    curTetromino_ = tetromino;
+    curMask_ = mask;
+    ghostDy_ = 0;
+    setCurTetrominoOnField_();
+    updateTetrominoGhost_();
+    return true;
+}
+
+bool BitboardTetrominoMovement::hardDrop() {
+    if (ghostDy_ == 0) {
+        return false;
+    }
+    deleteCurTetrominoGhostOnField_();
+    deleteCurTetrominoOnField_();
+    curTetromino_.moveDownSquares(ghostDy_);
+    curMask_.top += ghostDy_;
+    ghostDy_ = 0;
+    setCurTetrominoOnField_();
+    return true;
+}
+
+void BitboardTetrominoMovement::lockTetromino() {
+    for (auto b : curTetromino_.shape()) {
+        rows_[b.second] |= row_t{1} << (b.first + 1);
+        heights_[b.first] = std::min<int>(heights_[b.first], b.second);
+    }
+}
+
+void BitboardTetrominoMovement::linesDeleted(const std::vector<std::size_t>& rows) {
+    if (rows.empty()) {
+        return;
+    }
+    // rows under the lowest deleted one stay in place
+    int write = static_cast<int>(rows.back());
+    auto deleted = rows.rbegin();
+    for (int read = write; read >= 0; --read) {
+        if (deleted != rows.rend() && static_cast<int>(*deleted) == read) {
+            ++deleted;
+            continue;
+        }
+        rows_[write--] = rows_[read];
+    }
+    for (; write >= 0; --write) {
+        rows_[write] = emptyRow_;
+    }
+
+    // a deleted row is full, so no column is higher than the highest of them
+    int highestDeleted = static_cast<int>(rows.front());
+    int deletedCount = static_cast<int>(rows.size());
+    for (std::size_t x = 0; x < heights_.size(); ++x) {
+        if (heights_[x] < highestDeleted) {
+            heights_[x] += deletedCount;
+        } else {
+            heights_[x] = columnHeight_(x, heights_[x]);
+        }
+    }
+}
+
+BitboardTetrominoMovement::PieceMask 
+BitboardTetrominoMovement::makeMask_(const tetrominoes::Tetromino& tetromino) const {
+    PieceMask mask;
+    mask.top = tetromino.highestPointOnY();
+    mask.height = tetromino.lowestPointOnY() - mask.top + 1;
+    for (const auto& p : tetromino.shape()) {
+        mask.rows[p.second - mask.top] |= row_t{1} << (p.first + 1);
+    }
+    return mask;
+}
+
+bool BitboardTetrominoMovement::fits_(const PieceMask& mask, int dx, int dy) const {
+    int top = mask.top + dy;
+    if (top < 0 || top + mask.height > static_cast<int>(rows_.size())) {
+        return false;
+    }
+    for (int i = 0; i < mask.height; ++i) {
+        auto row = dx < 0 ? mask.rows[i] >> -dx : mask.rows[i] << dx;
+        if (rows_[top + i] & row) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int BitboardTetrominoMovement::dropDistance_(const PieceMask& mask) const {
+    int dy = 0;
+    while (fits_(mask, 0, dy + 1)) {
+        ++dy;
+    }
+    return dy;
+}
+
+int BitboardTetrominoMovement::ghostDropDistance_() const {
+    const auto& info = curTetromino_.shapeInfo();
+    int x0 = curTetromino_.leftmostPointOnX();
+    int y0 = curTetromino_.highestPointOnY();
+    int dy = INT_MAX;
+    for (int c = 0; c < info.width; ++c) {
+        int bottom = y0 + info.bottom[c];
+        int height = heights_[x0 + c];
+        if (bottom >= height) {
+            // tucked under an overhang, the height map can't tell
+            return dropDistance_(curMask_);
+        }
+        dy = std::min(dy, height - 1 - bottom);
+    }
+    return dy;
+}
+
+void BitboardTetrominoMovement::rebuildRows_() {
+    auto width = fieldWidth_();
+    auto height = static_cast<int>(fieldHeight_());
+    assert(width <= MAX_FIELD_WIDTH);
+    emptyRow_ = row_t{1} | (row_t{1} << (width + 1));
+    rows_.assign(height + 1, emptyRow_);
+    rows_.back() = ~row_t{0};
+    heights_.assign(width, height);
+    for (int y = height - 1; y >= 0; --y) {
+        decltype(auto) line = field_->operator[](y);
+        for (std::size_t x = 0; x < width; ++x) {
+            if (isLockedBlock(line[x])) {
+                rows_[y] |= row_t{1} << (x + 1);
+                heights_[x] = y;
+            }
+        }
+    }
+}
+
+int BitboardTetrominoMovement::columnHeight_(std::size_t x, std::size_t fromY) const {
+    auto bit = row_t{1} << (x + 1);
+    for (auto y = fromY; y < fieldHeight_(); ++y) {
+        if (rows_[y] & bit) {
+            return static_cast<int>(y);
+        }
+    }
+    return static_cast<int>(fieldHeight_());
+}
+
+void BitboardTetrominoMovement::setCurTetrominoOnField_() {
+    auto block = TetrominoTypeToBlockType(curTetromino_.type());
+    for (auto b : curTetromino_.shape()) {
+        writeBlock_(b.first, b.second, block);
+    }
+}
+
+void BitboardTetrominoMovement::deleteCurTetrominoOnField_() {
+    for (auto b : curTetromino_.shape()) {
+        writeBlock_(b.first, b.second, BlockType::VOID);
+    }
+}
+
+void BitboardTetrominoMovement::deleteCurTetrominoGhostOnField_() {
+    for (auto b : curTetromino_.shape()) {
+        auto y = b.second + ghostDy_;
+        if (field_->operator[](y)[b.first] == BlockType::GHOST) {
+            writeBlock_(b.first, y, BlockType::VOID);
+        }
+    }
+}
+
+void BitboardTetrominoMovement::updateTetrominoGhost_() {
+    ghostDy_ = ghostDropDistance_();
+    for (auto b : curTetromino_.shape()) {
+        auto y = b.second + ghostDy_;
+        if (field_->operator[](y)[b.first] == BlockType::VOID) {
+            writeBlock_(b.first, y, BlockType::GHOST);
+        }
+    }
+}
+
+std::size_t BitboardTetrominoMovement::fieldWidth_() const {
+    return field_->at(0).size();
+}
+
+std::size_t BitboardTetrominoMovement::fieldHeight_() const {
+    return field_->size();
+}
+
 } // namespace tetromino_movement
\ No newline at end of file
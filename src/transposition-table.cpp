@@ -0,0 +1,45 @@
+#include "../include/transposition-table.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace transposition_table {
+
+// ##################################################
+// TranspositionTable
+TranspositionTable::TranspositionTable(std::size_t entries) :
+    entries_(std::bit_ceil(std::max<std::size_t>(entries, 1)))
+    , mask_(entries_.size() - 1)
+{}
+
+std::optional<double> TranspositionTable::probe(std::uint64_t key) const {
+    const auto& entry = entries_[slot_(key)];
+    auto value = entry.value.load(std::memory_order_relaxed);
+    auto check = entry.check.load(std::memory_order_relaxed);
+    if ((check ^ value) != key) return std::nullopt;
+    return std::bit_cast<double>(value);
+}
+
+void TranspositionTable::store(std::uint64_t key, double value) {
+    auto& entry = entries_[slot_(key)];
+    auto bits = std::bit_cast<std::uint64_t>(value);
+    entry.check.store(key ^ bits, std::memory_order_relaxed);
+    entry.value.store(bits, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (auto& entry : entries_) {
+        entry.check.store(0, std::memory_order_relaxed);
+        entry.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::size_t TranspositionTable::size() const {
+    return entries_.size();
+}
+
+std::size_t TranspositionTable::slot_(std::uint64_t key) const {
+    return key & mask_;
+}
+
+} // namespace transposition_table
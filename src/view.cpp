@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <charconv>
 #include <cmath>
 #include <iostream>
 #include <vector>
@@ -6,83 +7,230 @@
 
 #include "../include/view.hpp"
 
-#include <SFML/System/Angle.hpp>
-
+#include "../include/bitmap-font.hpp"
 #include "../include/tetris-game-model.hpp"
 
 using namespace tetris_game_model;
 
 namespace {
 
-void drawVerticalLine(sf::RenderWindow& window, 
-                           sf::Vector2f start, 
-                           float lenght, 
-                           float thickness,
-                           sf::Color color) 
-{
-    sf::RectangleShape line({lenght, thickness});
-    line.setPosition({start.x + thickness, start.y});
-    line.setFillColor(color);
-    line.rotate(sf::degrees(90));
-    window.draw(line);
-}
-
-void drawHorizontalLine(sf::RenderWindow& window, 
-                             sf::Vector2f start, 
-                             float lenght, 
-                             float thickness,
-                             sf::Color color) 
+constexpr std::size_t VERTICES_PER_RECT = 6;
+
+// writes a rectangle as two triangles starting at arr[first]
+void setRect(std::vector<sf::Vertex>& arr, 
+             std::size_t first, 
+             sf::Vector2f pos, 
+             sf::Vector2f size, 
+             sf::Color color) 
 {
-    sf::RectangleShape line({lenght, thickness});
-    line.setPosition(start);
-    line.setFillColor(color);
-    window.draw(line);
+    sf::Vector2f corners[4] = {
+        pos,
+        {pos.x + size.x, pos.y},
+        {pos.x, pos.y + size.y},
+        {pos.x + size.x, pos.y + size.y}
+    };
+    constexpr std::size_t order[VERTICES_PER_RECT] = {0, 1, 2, 2, 1, 3};
+    for (std::size_t i = 0; i < VERTICES_PER_RECT; ++i) {
+        arr[first + i].position = corners[order[i]];
+        arr[first + i].color = color;
+    }
 }
 
+void setRectColor(std::vector<sf::Vertex>& arr, std::size_t first, sf::Color color) {
+    for (std::size_t i = 0; i < VERTICES_PER_RECT; ++i) {
+        arr[first + i].color = color;
+    }
+}
+
+using Samples = perf_stats::RollingSamples<perf_stats::PerfStats::WINDOW>;
+
+struct HudRow {
+    std::string_view label;
+    Samples perf_stats::PerfStats::* samples;
+    // recorded units per shown one
+    std::int64_t divisor;
+    // digits shown after the point
+    int decimals;
+    std::string_view unit;
+};
+
+// times are recorded in nanoseconds and shown in milliseconds
+constexpr HudRow HUD_ROWS[] = {
+    {"frame", &perf_stats::PerfStats::frameTime, 1'000'000, 3, "ms"},
+    {"model", &perf_stats::PerfStats::modelUpdate, 1'000'000, 3, "ms"},
+    {"input", &perf_stats::PerfStats::inputLatency, 1'000'000, 3, "ms"},
+    {"queue", &perf_stats::PerfStats::queueDepth, 1, 0, ""},
+    {"lock", &perf_stats::PerfStats::lockWait, 1'000'000, 3, "ms"},
+};
+
+constexpr std::size_t HUD_LABEL_WIDTH = 6;
+constexpr std::size_t HUD_VALUE_WIDTH = 9;
+
+// value / divisor right-aligned in width characters, at least one of them
+// a space; a value too wide is clamped and marked with a '>' in that space
+char* writeHudValue(char* out, std::int64_t value, std::int64_t divisor, int decimals) {
+    std::int64_t scale = 1;
+    for (int i = 0; i < decimals; ++i) scale *= 10;
+    // all nines that fit next to the space, the point and the decimals
+    std::int64_t limit = 1;
+    for (std::size_t i = 0; i + 1 + (decimals > 0 ? decimals + 1 : 0) < HUD_VALUE_WIDTH; ++i) {
+        limit *= 10;
+    }
+    limit = limit * scale - 1;
+
+    auto scaled = std::max<std::int64_t>(value, 0) / (divisor / scale);
+    bool isClamped = scaled > limit;
+    scaled = std::min(scaled, limit);
+
+    char digits[HUD_VALUE_WIDTH];
+    auto end = std::to_chars(digits, digits + sizeof(digits), scaled / scale).ptr;
+    if (decimals > 0) {
+        *end++ = '.';
+        auto fraction = scaled % scale;
+        for (auto div = scale / 10; div > 0; div /= 10) {
+            *end++ = static_cast<char>('0' + fraction / div % 10);
+        }
+    }
+    auto len = static_cast<std::size_t>(end - digits);
+    std::fill_n(out, HUD_VALUE_WIDTH - len, ' ');
+    if (isClamped) out[HUD_VALUE_WIDTH - len - 1] = '>';
+    return std::copy(digits, end, out + (HUD_VALUE_WIDTH - len));
+}
 
 } // namespace 
 
 namespace view {
 
+// ##################################################
+// IDrawable
+void IDrawable::invalidate_(bool isSizeChanged) {
+    for (auto parent = parent_; parent; parent = parent->parent_) {
+        parent->onChildInvalidated_(isSizeChanged);
+    }
+}
+
 // ##################################################
 // IDrawableComposite
+IDrawableComposite::~IDrawableComposite() {
+    for (auto& comp : components_) {
+        comp->parent_ = nullptr;
+    }
+}
+
 void IDrawableComposite::addComponent(
     std::shared_ptr<IDrawable> comp, const std::string& name) {
+    auto& slot = slot_(name);
+    assert(!slot->component && "component names must be unique in the tree");
+    slot->component = comp;
+
     auto it = components_.insert(components_.end(), comp);
     componentsMap_.emplace(name, it);
+    comp->parent_ = this;
+    if (auto composite = dynamic_cast<IDrawableComposite*>(comp.get())) {
+        composite->mergeIndexIntoRoot_();
+    }
+    onChildInvalidated_(true);
+    invalidate_(true);
 }
 
 std::shared_ptr<IDrawable> IDrawableComposite::getComponent(
     const std::string& name) {
-    if (componentsMap_.contains(name)) {
-        return *componentsMap_[name];
-    }
-    for (auto p : components_) {
-        auto drawable 
-            = std::dynamic_pointer_cast<IDrawableComposite>(p);
-        if (drawable) {
-            auto res = drawable->getComponent(name);
-            if (res) {
-                return res;
-            }
-        }     
-    }
-    return nullptr;
+    const auto& index = root_()->index_;
+    auto found = index.find(name);
+    if (found == index.end()) return nullptr;
+    const auto& comp = found->second->component;
+    return comp && isInSubtree_(comp.get()) ? comp : nullptr;
 }
 
 void IDrawableComposite::deleteComponent(const std::string& name) {
-    if (componentsMap_.contains(name)) {
-        auto it = componentsMap_.find(name);
-        components_.erase(it->second);
-        componentsMap_.erase(it);
-        return;
+    auto* root = root_();
+    auto found = root->index_.find(name);
+    if (found == root->index_.end()) return;
+    auto comp = found->second->component;
+    if (!comp || !isInSubtree_(comp.get())) return;
+
+    auto* parent = comp->parent_;
+    auto it = parent->componentsMap_.find(name);
+    parent->components_.erase(it->second);
+    parent->componentsMap_.erase(it);
+    comp->parent_ = nullptr;
+    found->second->component.reset();
+    root->unregisterSubtree_(*comp);
+
+    parent->onChildInvalidated_(true);
+    parent->invalidate_(true);
+}
+
+std::pair<float, float> IDrawableComposite::size() const {
+    if (!cachedSize_) {
+        cachedSize_ = measure_();
+    }
+    return *cachedSize_;
+}
+
+void IDrawableComposite::onChildInvalidated_(bool isSizeChanged) {
+    if (isSizeChanged) {
+        cachedSize_.reset();
+    }
+}
+
+IDrawableComposite* IDrawableComposite::root_() {
+    auto* root = this;
+    while (root->parent_) {
+        root = root->parent_;
     }
-    for (auto p : components_) {
-        auto drawable 
-            = std::dynamic_pointer_cast<IDrawableComposite>(p);
-        if (drawable) {
-            drawable->deleteComponent(name);
-        }     
+    return root;
+}
+
+bool IDrawableComposite::isInSubtree_(const IDrawable* comp) const {
+    for (auto parent = comp->parent_; parent; parent = parent->parent_) {
+        if (parent == this) return true;
+    }
+    return false;
+}
+
+std::shared_ptr<ComponentSlot>& IDrawableComposite::slot_(const std::string& name) {
+    auto& slot = root_()->index_[name];
+    if (!slot) {
+        slot = std::make_shared<ComponentSlot>();
+    }
+    return slot;
+}
+
+void IDrawableComposite::mergeIndexIntoRoot_() {
+    auto& rootIndex = root_()->index_;
+    for (auto& [name, slot] : index_) {
+        auto& rootSlot = rootIndex[name];
+        if (!rootSlot) {
+            rootSlot = std::move(slot);
+            continue;
+        }
+        // a handle was taken on the root before this subtree was added
+        assert(!(rootSlot->component && slot->component) 
+               && "component names must be unique in the tree");
+        if (slot->component) {
+            rootSlot->component = std::move(slot->component);
+        }
+    }
+    index_.clear();
+}
+
+void IDrawableComposite::unregisterSubtree_(IDrawable& comp) {
+    auto* detached = dynamic_cast<IDrawableComposite*>(&comp);
+    if (!detached) return;
+    std::vector<IDrawableComposite*> nodes {detached};
+    while (!nodes.empty()) {
+        auto* node = nodes.back();
+        nodes.pop_back();
+        for (const auto& [name, it] : node->componentsMap_) {
+            if (auto found = index_.find(name); found != index_.end()) {
+                found->second->component.reset();
+            }
+            detached->index_[name] = std::make_shared<ComponentSlot>(*it);
+            if (auto* child = dynamic_cast<IDrawableComposite*>(it->get())) {
+                nodes.push_back(child);
+            }
+        }
     }
 }
 
@@ -103,31 +251,26 @@ void DrawableStackLayout::deleteComponent(const std::string& name) {
     IDrawableComposite::deleteComponent(name);
 }
 
-void DrawableStackLayout::draw(sf::RenderWindow& window, sf::Vector2f start) {
+void DrawableStackLayout::draw(render_target::IRenderTarget& target, sf::Vector2f start) {
     auto curStart = start;
-    auto it = components_.rbegin(); 
-    auto end = components_.rend();
-    for (auto comp = *it; it != end; ++it) {
-        comp = *it;
-        comp->draw(window, curStart);
-        auto compSz = comp->size();
+    for (auto it = components_.rbegin(); it != components_.rend(); ++it) {
+        const auto& comp = *it;
+        comp->draw(target, curStart);
         curStart = {
             curStart.x,
-            curStart.y + compSz.second
+            curStart.y + comp->size().second
         };
     }
 }
 
-std::pair<float, float> DrawableStackLayout::size() const {
-    if (components_.empty()) return {0., 0.};
-
-    float width = components_.front()->size().first;
+std::pair<float, float> DrawableStackLayout::measure_() const {
+    float width = 0;
     float height = 0;
     for (const auto& comp : components_) {
-        width = std::max(width, comp->size().first);
-        height += comp->size().second;
+        auto compSz = comp->size();
+        width = std::max(width, compSz.first);
+        height += compSz.second;
     }
-
     return {width, height};
 }  
 
@@ -138,10 +281,10 @@ DrawableNestedLayout::DrawableNestedLayout(float widthOffset, float heightOffset
     , heightOffset_(heightOffset)
 {}
 
-void DrawableNestedLayout::draw(sf::RenderWindow& window, sf::Vector2f start) {
+void DrawableNestedLayout::draw(render_target::IRenderTarget& target, sf::Vector2f start) {
     auto curStart = start;
     for (auto comp : components_) {
-        comp->draw(window, curStart);
+        comp->draw(target, curStart);
         curStart = {
             curStart.x + widthOffset_,
             curStart.y + heightOffset_
@@ -149,7 +292,7 @@ void DrawableNestedLayout::draw(sf::RenderWindow& window, sf::Vector2f start) {
     }
 }
 
-std::pair<float, float> DrawableNestedLayout::size() const {
+std::pair<float, float> DrawableNestedLayout::measure_() const {
     if (components_.empty()) return {0., 0.};
     return components_.front()->size();
 }
@@ -185,56 +328,114 @@ float DrawableNestedLayout::heightOffset() const {
 
 void DrawableNestedLayout::setWidthOffset(float offset) {
     widthOffset_ = offset;
+    invalidate_(false);
 }
 
 void DrawableNestedLayout::setHeightOffset(float offset) {
     heightOffset_ = offset;
+    invalidate_(false);
+}
+
+// ##################################################
+// DrawableRetainedLayer
+void DrawableRetainedLayer::draw(render_target::IRenderTarget& target, sf::Vector2f start) {
+    if (components_.empty()) return;
+    auto& comp = components_.front();
+    auto sz = size();
+    sf::Vector2u layerSz(
+        static_cast<unsigned>(std::ceil(sz.first)), 
+        static_cast<unsigned>(std::ceil(sz.second)));
+    if (!layer_ || layerOwner_ != &target || layerSize_ != layerSz) {
+        layer_ = target.createLayer(layerSz);
+        layerOwner_ = &target;
+        layerSize_ = layerSz;
+        isDirty_ = true;
+    }
+    if (!layer_) {
+        // no off-screen target available, draw directly
+        comp->draw(target, start);
+        return;
+    }
+    if (isDirty_) {
+        auto& layerTarget = layer_->target();
+        layerTarget.clear(sf::Color::Transparent);
+        comp->draw(layerTarget, {0.f, 0.f});
+        layerTarget.display();
+        isDirty_ = false;
+        ++renderCount_;
+    }
+    target.drawLayer(*layer_, start);
+}
+
+void DrawableRetainedLayer::addComponent(
+    std::shared_ptr<IDrawable> comp, const std::string& name) {
+    assert(components_.empty());
+    IDrawableComposite::addComponent(comp, name);
+}
+
+std::shared_ptr<IDrawable> DrawableRetainedLayer::getComponent(
+    const std::string& name) {
+    return IDrawableComposite::getComponent(name);
+}
+
+void DrawableRetainedLayer::deleteComponent(const std::string& name) {
+    IDrawableComposite::deleteComponent(name);
+}
+
+std::size_t DrawableRetainedLayer::renderCount() const {
+    return renderCount_;
+}
+
+std::pair<float, float> DrawableRetainedLayer::measure_() const {
+    if (components_.empty()) return {0., 0.};
+    return components_.front()->size();
+}
+
+void DrawableRetainedLayer::onChildInvalidated_(bool isSizeChanged) {
+    IDrawableComposite::onChildInvalidated_(isSizeChanged);
+    isDirty_ = true;
 }
 
 // ##################################################
 // DrawableFrame
 DrawableFrame::DrawableFrame(float width, float height, float thickness, sf::Color color) :
         thickness_(thickness)
-        , externalRect_({width, height})
         , color_(color)
+        , size_(width, height)
 {
     if (thickness > std::min(width, height)) {
         throw std::logic_error("thickness > min(width, height)");
     }
-        
-    auto interWidth = width - thickness * 2;
-    auto interHeigh = height - thickness * 2;
-    internalRect_ = sf::RectangleShape({interWidth, interHeigh});
-
-    externalRect_.setFillColor(color_);
 }
 
-void DrawableFrame::draw(sf::RenderWindow& window, sf::Vector2f start) {
+void DrawableFrame::draw(render_target::IRenderTarget& target, sf::Vector2f start) {
     sf::Vector2f interPos(
         start.x + thickness_,
         start.y + thickness_  
     );
-    externalRect_.setPosition(start);
-    internalRect_.setPosition(interPos);
-    window.draw(externalRect_);
-    window.draw(internalRect_);
+    sf::Vector2f interSize(
+        size_.x - thickness_ * 2,
+        size_.y - thickness_ * 2
+    );
+    target.fillRect({start, size_}, color_);
+    target.fillRect({interPos, interSize}, internalColor_);
 }
 
 std::pair<float, float> DrawableFrame::size() const {
-    auto sz = externalRect_.getSize();
-    return {sz.x, sz.y};
+    return {size_.x, size_.y};
 }
 
 void DrawableFrame::setThickness(float thickness) {
     thickness_ = thickness;
+    invalidate_(false);
 }
 
 float DrawableFrame::thickness() const { return thickness_; }
 
 void DrawableFrame::setColor(sf::Color color) {
-    externalRect_.setFillColor(color);
-    internalRect_.setFillColor(color);
+    internalColor_ = color;
     color_ = color;
+    invalidate_(false);
 }
 
 sf::Color DrawableFrame::color() const {
@@ -250,25 +451,24 @@ DrawableGridCanvas::DrawableGridCanvas(float width,
                                       float gridThickness,
                                       sf::Color gridColor) : 
     gridThickness_(gridThickness)
-    , width_(width)
-    , height_(height)
     , widthInCells_(widthInCells)
     , heightInCells_(heightInCells)
+    , width_(width)
+    , height_(height)
     , gridColor_(gridColor)
 {   
     cellWidth_ = ((width - gridThickness_) - (gridThickness_ * widthInCells)) 
                  / widthInCells;
     cellHeight_ = ((height - gridThickness_) - (gridThickness_ * heightInCells)) 
                  / heightInCells;
+    buildCells_();
+    buildGrid_();
 }
 
-void DrawableGridCanvas::draw(sf::RenderWindow& window, sf::Vector2f start) {
-    drawGrid_(window, start);
-    for (const auto& cell : cells_) {
-        auto x = cell.pos.first;
-        auto y = cell.pos.second;
-        drawCellAt_(x, y, start, window, cell.color);
-    }
+void DrawableGridCanvas::draw(render_target::IRenderTarget& target, sf::Vector2f start) {
+    uploadColors_();
+    target.drawTriangles(gridVertices_, start);
+    target.drawTriangles(cellVertices_, start);
 }
 
 std::pair<float, float> DrawableGridCanvas::size() const {
@@ -277,47 +477,166 @@ std::pair<float, float> DrawableGridCanvas::size() const {
 
 void DrawableGridCanvas::paintCell(
     std::pair<std::size_t, std::size_t> pos, sf::Color color) {
-    cells_.emplace_back(pos, color);
+    paintCell(pos, colorIndex_(color));
+}
+
+void DrawableGridCanvas::paintCell(
+    std::pair<std::size_t, std::size_t> pos, std::uint8_t index) {
+    assert(pos.first < widthInCells_ && pos.second < heightInCells_);
+    assert(index < palette_.size());
+    auto& cell = cells_[pos.second * widthInCells_ + pos.first];
+    if (cell == index) return;
+    cell = index;
+    markRowDirty_(pos.second);
+}
+
+void DrawableGridCanvas::paintRow(std::size_t y, std::span<const std::uint8_t> indices) {
+    assert(y < heightInCells_ && indices.size() == widthInCells_);
+    auto row = cells_.begin() + y * widthInCells_;
+    if (std::equal(indices.begin(), indices.end(), row)) return;
+    assert(std::all_of(indices.begin(), indices.end(),
+                       [this](auto i) { return i < palette_.size(); }));
+    std::copy(indices.begin(), indices.end(), row);
+    markRowDirty_(y);
+}
+
+void DrawableGridCanvas::paintRow(
+    std::size_t y, std::span<const tetris_game_model::BlockType> blocks) {
+    static_assert(sizeof(tetris_game_model::BlockType) == sizeof(std::uint8_t));
+    // reading an object through unsigned char is always allowed
+    paintRow(y, {reinterpret_cast<const std::uint8_t*>(blocks.data()), blocks.size()});
+}
+
+std::uint8_t DrawableGridCanvas::cellIndex(std::pair<std::size_t, std::size_t> pos) const {
+    assert(pos.first < widthInCells_ && pos.second < heightInCells_);
+    return cells_[pos.second * widthInCells_ + pos.first];
 }
 
 void DrawableGridCanvas::clear() {
-    cells_.clear();
+    std::fill(cells_.begin(), cells_.end(), colorIndex_(sf::Color::Transparent));
+    std::fill(dirtyRows_.begin(), dirtyRows_.end(), 1);
+    hasDirtyRows_ = true;
+    invalidate_(false);
 }
 
-void DrawableGridCanvas::drawCellAt_(std::size_t cellX, 
-                                     std::size_t cellY,
-                                     sf::Vector2f start,
-                                     sf::RenderWindow& window,
-                                     sf::Color blockColor) 
-{   
-    float x = start.x 
-              + cellX * cellWidth_ 
-              + gridThickness_ * (cellX + 1);
-    float y = start.y
-            + cellY * cellHeight_ 
-            + gridThickness_ * (cellY + 1);
-    sf::Vector2f pos {x , y};
+void DrawableGridCanvas::setPalette(std::span<const sf::Color> palette) {
+    assert(!palette.empty() && palette.size() <= MAX_PALETTE_SIZE);
+    assert(std::all_of(cells_.begin(), cells_.end(),
+                       [&](auto i) { return i < palette.size(); }));
+    palette_.assign(palette.begin(), palette.end());
+    std::fill(dirtyRows_.begin(), dirtyRows_.end(), 1);
+    hasDirtyRows_ = true;
+    invalidate_(false);
+}
 
-    sf::RectangleShape block({cellWidth_, cellHeight_});
-    block.setPosition(pos);
+std::span<const sf::Color> DrawableGridCanvas::palette() const {
+    return palette_;
+}
 
-    block.setFillColor(blockColor);
+sf::Color DrawableGridCanvas::gridColor() const {
+    return gridColor_;
+}
 
-    window.draw(block);
+void DrawableGridCanvas::setGridColor(sf::Color color) {
+    gridColor_ = color;
+    for (std::size_t i = 0; i < gridVertices_.size(); ++i) {
+        gridVertices_[i].color = color;
+    }
+    invalidate_(false);
 }
 
+std::uint8_t DrawableGridCanvas::colorIndex_(sf::Color color) {
+    auto it = std::find(palette_.begin(), palette_.end(), color);
+    if (it == palette_.end()) {
+        assert(palette_.size() < MAX_PALETTE_SIZE);
+        it = palette_.insert(palette_.end(), color);
+    }
+    return static_cast<std::uint8_t>(it - palette_.begin());
+}
 
-void DrawableGridCanvas::drawGrid_(sf::RenderWindow& window, sf::Vector2f start) {
-    float limX = start.x + width_;
-    int c = 0;
-    for (float x = start.x; x < limX; x += cellWidth_ + gridThickness_) {
-        drawVerticalLine(window, {x, start.y}, height_, gridThickness_, gridColor_);
+void DrawableGridCanvas::markRowDirty_(std::size_t y) {
+    if (!dirtyRows_[y]) {
+        dirtyRows_[y] = 1;
+        hasDirtyRows_ = true;
     }
+    invalidate_(false);
+}
+
+// the vertex colours are the only per-cell data the targets see
+void DrawableGridCanvas::uploadColors_() {
+    if (!hasDirtyRows_) return;
+    for (std::size_t y = 0; y < heightInCells_; ++y) {
+        if (!dirtyRows_[y]) continue;
+        dirtyRows_[y] = 0;
+        auto first = y * widthInCells_;
+        for (std::size_t x = 0; x < widthInCells_; ++x) {
+            setRectColor(cellVertices_, (first + x) * VERTICES_PER_RECT, 
+                         palette_[cells_[first + x]]);
+        }
+    }
+    hasDirtyRows_ = false;
+}
+
+void DrawableGridCanvas::buildCells_() {
+    cells_.assign(widthInCells_ * heightInCells_, 0);
+    palette_.assign(1, sf::Color::Transparent);
+    dirtyRows_.assign(heightInCells_, 0);
+    cellVertices_.resize(widthInCells_ * heightInCells_ * VERTICES_PER_RECT);
+    std::size_t first = 0;
+    for (std::size_t cellY = 0; cellY < heightInCells_; ++cellY) {
+        for (std::size_t cellX = 0; cellX < widthInCells_; ++cellX) {
+            sf::Vector2f pos {
+                cellX * cellWidth_ + gridThickness_ * (cellX + 1),
+                cellY * cellHeight_ + gridThickness_ * (cellY + 1)
+            };
+            setRect(cellVertices_, first, pos, {cellWidth_, cellHeight_}, 
+                    sf::Color::Transparent);
+            first += VERTICES_PER_RECT;
+        }
+    }
+}
+
+void DrawableGridCanvas::buildGrid_() {
+    gridVertices_.clear();
+    auto addLine = [this](sf::Vector2f pos, sf::Vector2f size) {
+        auto first = gridVertices_.size();
+        gridVertices_.resize(first + VERTICES_PER_RECT);
+        setRect(gridVertices_, first, pos, size, gridColor_);
+    };
+    for (std::size_t i = 0; i <= widthInCells_; ++i) {
+        float x = i * (cellWidth_ + gridThickness_);
+        addLine({x, 0.f}, {gridThickness_, height_});
+    }
+    for (std::size_t i = 0; i <= heightInCells_; ++i) {
+        float y = i * (cellHeight_ + gridThickness_);
+        addLine({0.f, y}, {width_, gridThickness_});
+    }
+}
 
-    float limY = start.y + height_;
-    for (float y = start.y; y < limY; y += cellHeight_ + gridThickness_) {
-        drawHorizontalLine(window, {start.x, y}, width_, gridThickness_, gridColor_);
+// ##################################################
+// FontCache
+FontCache& FontCache::instance() {
+    static FontCache cache;
+    return cache;
+}
+
+std::shared_ptr<const sf::Font> FontCache::get(const std::string& path) {
+    std::lock_guard<std::mutex> lk{mut_};
+    auto& font = fonts_[path];
+    if (!font) {
+        try {
+            font = std::make_shared<const sf::Font>(path);
+        } catch (...) {
+            fonts_.erase(path);
+            throw;
+        }
     }
+    return font;
+}
+
+std::size_t FontCache::size() const {
+    std::lock_guard<std::mutex> lk{mut_};
+    return fonts_.size();
 }
 
 // ##################################################
@@ -325,36 +644,111 @@ void DrawableGridCanvas::drawGrid_(sf::RenderWindow& window, sf::Vector2f start)
 DrawableText::DrawableText(std::string txt, int characterSize, 
                            std::string font, sf::Color color, 
                            sf::Vector2f startPos) :
-    font_(font)
+    font_(font.empty() ? nullptr : FontCache::instance().get(font))
+    , text_(std::move(txt))
     , characterSize_(characterSize)
+    , color_(color)
     , startPos_(startPos)
-    , sfTxt_(font_) 
 {
-    sfTxt_.setString(txt);
-    sfTxt_.setFillColor(color);
-    sfTxt_.setCharacterSize(characterSize_);
+    if (font_) {
+        sfTxt_.emplace(*font_, text_, characterSize_);
+        sfTxt_->setFillColor(color_);
+    }
+    measure_();
 }
 
-void DrawableText::draw(sf::RenderWindow& window, sf::Vector2f start) {
+void DrawableText::draw(render_target::IRenderTarget& target, sf::Vector2f start) {
     sf::Vector2f newStart = {
         start.x + startPos_.x,
         start.y + startPos_.y
     };
-    sfTxt_.setPosition(newStart);
-    window.draw(sfTxt_);
+    if (sfTxt_ && sfTxt_->getPosition() != newStart) {
+        sfTxt_->setPosition(newStart);
+    }
+    target.drawText({
+        text_, 
+        static_cast<unsigned>(characterSize_), 
+        color_, 
+        newStart, 
+        sfTxt_ ? &*sfTxt_ : nullptr
+    });
 }
 
 std::pair<float, float> DrawableText::size() const {
-    auto boundsSz = sfTxt_.getLocalBounds().size;
-    return {boundsSz.x, boundsSz.y + characterSize_};
+    return {boundsSize_.x, boundsSize_.y + characterSize_};
 }
 
-void DrawableText::setText(const std::string& txt) {
-    sfTxt_.setString(txt);
+void DrawableText::setText(std::string_view txt) {
+    if (text_ == txt) return;
+    text_.assign(txt);
+    if (sfTxt_) {
+        sfTxt_->setString(text_);
+    }
+    measure_();
+    invalidate_(true);
+}
+
+const std::string& DrawableText::text() const {
+    return text_;
+}
+
+void DrawableText::measure_() {
+    if (sfTxt_) {
+        boundsSize_ = sfTxt_->getLocalBounds().size;
+        return;
+    }
+    auto bounds = bitmap_font::measure(text_, characterSize_);
+    boundsSize_ = {bounds[0], bounds[1]};
+}
+
+// ##################################################
+// DrawablePerfHud
+DrawablePerfHud::DrawablePerfHud(std::shared_ptr<const perf_stats::PerfStats> stats,
+                                 int characterSize, sf::Color color, 
+                                 sf::Vector2f startPos) :
+    stats_(std::move(stats))
+    , characterSize_(characterSize)
+    , color_(color)
+    , startPos_(startPos)
+{
+    static_assert(std::size(HUD_ROWS) + 1 == LINE_COUNT);
+    static_assert(HUD_LABEL_WIDTH + 3 * HUD_VALUE_WIDTH + 3 == LINE_LENGTH);
+    assert(stats_);
+}
+
+void DrawablePerfHud::draw(render_target::IRenderTarget& target, sf::Vector2f start) {
+    sf::Vector2f pos = {start.x + startPos_.x, start.y + startPos_.y};
+    auto drawLine = [&] {
+        target.drawText({
+            {line_.data(), line_.size()}, 
+            static_cast<unsigned>(characterSize_), 
+            color_, 
+            pos
+        });
+        pos.y += characterSize_;
+    };
+
+    static constexpr std::string_view header = "            p50      p99      max   ";
+    std::copy(header.begin(), header.end(), line_.begin());
+    drawLine();
+
+    for (const auto& row : HUD_ROWS) {
+        auto p = ((*stats_).*row.samples).percentiles();
+        line_.fill(' ');
+        std::copy(row.label.begin(), row.label.end(), line_.begin());
+        auto out = line_.data() + HUD_LABEL_WIDTH;
+        out = writeHudValue(out, p.p50, row.divisor, row.decimals);
+        out = writeHudValue(out, p.p99, row.divisor, row.decimals);
+        out = writeHudValue(out, p.max, row.divisor, row.decimals);
+        std::copy(row.unit.begin(), row.unit.end(), out + 1);
+        drawLine();
+    }
 }
 
-std::string DrawableText::text() const {
-    return sfTxt_.getString();
+std::pair<float, float> DrawablePerfHud::size() const {
+    auto bounds = bitmap_font::measure(
+        std::string_view(line_.data(), line_.size()), characterSize_);
+    return {bounds[0], LINE_COUNT * characterSize_ + static_cast<float>(characterSize_)};
 }
 
 } // namespace view
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "../include/weight-tuning.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cmath>
+
+#include "../include/tetris-game-model.hpp"
+
+using lookahead_bot::Weights;
+
+namespace weight_tuning {
+
+namespace {
+
+// shortest text that parses back to the same double, so a row's weights
+// replay its games
+void writeNumber(std::ostream& out, double value) {
+    char buf[32];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    assert(ec == std::errc());
+    out.write(buf, end - buf);
+}
+
+} // namespace
+
+// ##################################################
+// weights
+weight_vector_t toVector(const Weights& weights) {
+    return {
+        weights.aggregateHeight,
+        weights.linesCleared,
+        weights.holes,
+        weights.bumpiness,
+        weights.wells,
+        weights.rowTransitions,
+        weights.columnTransitions,
+    };
+}
+
+Weights fromVector(const weight_vector_t& vector) {
+    return {vector[0], vector[1], vector[2], vector[3], vector[4], vector[5], vector[6]};
+}
+
+const char* weightName(std::size_t i) {
+    constexpr std::array<const char*, WEIGHTS_COUNT> names {
+        "aggregate_height",
+        "lines_cleared",
+        "holes",
+        "bumpiness",
+        "wells",
+        "row_transitions",
+        "column_transitions",
+    };
+    assert(i < names.size());
+    return names[i];
+}
+
+simulation::GameResult playGame(
+    task_pool::TaskPool& pool, const Weights& weights, const GameSetup& setup,
+    std::uint64_t seed) {
+    tetris_game_model::TetrisGameModel model(setup.width, setup.height, seed);
+    lookahead_bot::LookaheadPolicy policy(pool, weights, setup.search);
+    return simulation::playGame(model, policy, setup.maxPieces);
+}
+
+// ##################################################
+// CrossEntropyTuner
+CrossEntropyTuner::CrossEntropyTuner(
+    task_pool::TaskPool& pool, TuningOptions options, Weights initial) :
+    pool_(pool)
+    , options_(options)
+    , mean_(toVector(initial))
+    , gen_(options.seed)
+{
+    assert(options_.population > 0 && options_.elites > 0 && options_.gamesPerCandidate > 0);
+    options_.elites = std::min(options_.elites, options_.population);
+    deviation_.fill(options_.initialDeviation);
+}
+
+std::span<const Candidate> CrossEntropyTuner::step() {
+    std::normal_distribution<double> normal;
+    candidates_.resize(options_.population);
+    for (std::size_t i = 0; i < candidates_.size(); ++i) {
+        weight_vector_t sample;
+        for (std::size_t w = 0; w < WEIGHTS_COUNT; ++w) {
+            sample[w] = mean_[w] + deviation_[w] * normal(gen_);
+        }
+        candidates_[i] = {generation_, i, fromVector(sample), {}};
+    }
+
+    // every game of the generation at once, a candidate's games may finish
+    // on different threads
+    auto games = options_.gamesPerCandidate;
+    auto firstSeed = options_.seed + generation_ * games;
+    std::vector<simulation::GameResult> results(candidates_.size() * games);
+    {
+        task_pool::TaskGroup group(pool_);
+        for (std::size_t i = 0; i < candidates_.size(); ++i) {
+            for (std::size_t g = 0; g < games; ++g) {
+                group.run([&, i, g] {
+                    results[i * games + g] = playGame(
+                        pool_, candidates_[i].weights, options_.setup, firstSeed + g);
+                });
+            }
+        }
+        group.wait();
+    }
+    for (std::size_t i = 0; i < candidates_.size(); ++i) {
+        auto& fitness = candidates_[i].fitness;
+        for (std::size_t g = 0; g < games; ++g) {
+            const auto& res = results[i * games + g];
+            fitness.meanScore += res.score;
+            fitness.meanLines += res.lines;
+            fitness.meanPieces += res.pieces;
+            fitness.gamesLost += res.isFinished;
+        }
+        fitness.meanScore /= games;
+        fitness.meanLines /= games;
+        fitness.meanPieces /= games;
+    }
+    // ties stay in the order they were drawn, the same elites every run
+    std::stable_sort(candidates_.begin(), candidates_.end(), [](const auto& a, const auto& b) {
+        return a.fitness.meanScore > b.fitness.meanScore;
+    });
+
+    auto elites = std::span(candidates_).first(options_.elites);
+    for (std::size_t w = 0; w < WEIGHTS_COUNT; ++w) {
+        double sum = 0.0;
+        for (const auto& elite : elites) sum += toVector(elite.weights)[w];
+        auto mean = sum / elites.size();
+        double variance = 0.0;
+        for (const auto& elite : elites) {
+            auto diff = toVector(elite.weights)[w] - mean;
+            variance += diff * diff;
+        }
+        mean_[w] = mean;
+        deviation_[w] = std::sqrt(variance / elites.size() + options_.extraVariance);
+    }
+    ++generation_;
+    return candidates_;
+}
+
+std::size_t CrossEntropyTuner::generation() const {
+    return generation_;
+}
+
+Weights CrossEntropyTuner::mean() const {
+    return fromVector(mean_);
+}
+
+weight_vector_t CrossEntropyTuner::deviation() const {
+    return deviation_;
+}
+
+// ##################################################
+// CSV
+void writeCsvHeader(std::ostream& out) {
+    out << "generation,candidate";
+    for (std::size_t w = 0; w < WEIGHTS_COUNT; ++w) {
+        out << ',' << weightName(w);
+    }
+    out << ",mean_score,mean_lines,mean_pieces,games_lost\n";
+}
+
+void writeCsvRow(std::ostream& out, const Candidate& candidate) {
+    out << candidate.generation << ',' << candidate.index;
+    for (auto weight : toVector(candidate.weights)) {
+        out << ',';
+        writeNumber(out, weight);
+    }
+    const auto& fitness = candidate.fitness;
+    out << ',';
+    writeNumber(out, fitness.meanScore);
+    out << ',';
+    writeNumber(out, fitness.meanLines);
+    out << ',';
+    writeNumber(out, fitness.meanPieces);
+    out << ',' << fitness.gamesLost << '\n';
+}
+
+} // namespace weight_tuning
@@ -0,0 +1,35 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// replaces the global operator new of the test that includes it, which
+// must be a single translation unit
+
+namespace allocation_counter {
+
+// operator new calls since the start, from every thread
+inline std::atomic<std::size_t> allocationsCount = 0;
+
+} // namespace allocation_counter
+
+void* operator new(std::size_t sz) {
+    ++allocation_counter::allocationsCount;
+    if (void* ptr = std::malloc(sz ? sz : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+#endif // ALLOCATION_COUNTER_HPP
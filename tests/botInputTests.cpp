@@ -0,0 +1,113 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "../include/player-input.hpp"
+#include "../include/tetris-game-model.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using namespace std::chrono_literals;
+using observer_n_subject::EventType;
+
+// applies the bot's moves to the model, as the controller would
+class MoveSink final : public observer_n_subject::IObserver {
+public:
+    MoveSink(std::shared_ptr<tetris_game_model::TetrisGameModel> model, std::mutex& modelMut) :
+        model_(std::move(model))
+        , modelMut_(modelMut)
+    {}
+
+    void update(observer_n_subject::ISubject&, EventType event) override {
+        std::lock_guard<std::mutex> lk{modelMut_};
+        switch (event) {
+            case EventType::USER_ASKED_LEFT: model_->moveLeftTetromino(); break;
+            case EventType::USER_ASKED_RIGHT: model_->moveRightTetromino(); break;
+            case EventType::USER_ASKED_ROTATE_RIGHT: model_->rotateRightTetromino(); break;
+            case EventType::USER_ASKED_DOWN: model_->updateModel(); break;
+            default: return;
+        }
+        ++moves;
+    }
+
+    std::uint64_t moves = 0;
+
+private:
+    std::shared_ptr<tetris_game_model::TetrisGameModel> model_;
+    std::mutex& modelMut_;
+};
+
+std::shared_ptr<MoveSink> attachSink(
+    player_input::BotInput& bot,
+    std::shared_ptr<tetris_game_model::TetrisGameModel> model, std::mutex& modelMut) {
+    auto sink = std::make_shared<MoveSink>(std::move(model), modelMut);
+    for (auto event : {EventType::USER_ASKED_LEFT, EventType::USER_ASKED_RIGHT,
+                       EventType::USER_ASKED_ROTATE_RIGHT, EventType::USER_ASKED_DOWN}) {
+        bot.attach(sink, event);
+    }
+    return sink;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    {
+        // far too deep to finish; every search is forced right after it is
+        // asked for, most likely before the thinking thread has taken it
+        constexpr std::uint64_t PIECES = 5;
+        auto model = std::make_shared<tetris_game_model::TetrisGameModel>(10, 20, 1);
+        std::mutex modelMut;
+        player_input::BotInput bot(model, modelMut, nullptr, {6, 32});
+        auto sink = attachSink(bot, model, modelMut);
+
+        auto forcedPiece = ~std::uint64_t{0};
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = start + 5s;
+        std::uint64_t pieces = 0;
+        while (pieces < PIECES && std::chrono::steady_clock::now() < deadline) {
+            {
+                std::lock_guard<std::mutex> lk{modelMut};
+                pieces = model->piecesLocked();
+            }
+            // a new piece is asked for by this poll
+            bot.pollInput();
+            if (pieces != forcedPiece) {
+                bot.forceDecision();
+                forcedPiece = pieces;
+            }
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << pieces << " pieces in "
+                  << std::chrono::duration<double, std::milli>(elapsed).count() << " ms, "
+                  << sink->moves << " moves\n";
+        ok &= check(pieces == PIECES && elapsed < 2s, "a forced search decides at once");
+    }
+
+    {
+        constexpr auto PERIOD = 20ms;
+        constexpr auto RUN = 300ms;
+        auto model = std::make_shared<tetris_game_model::TetrisGameModel>(10, 20, 2);
+        std::mutex modelMut;
+        player_input::BotInput bot(model, modelMut, nullptr, {1, 8}, PERIOD);
+        auto sink = attachSink(bot, model, modelMut);
+
+        auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < RUN) {
+            bot.pollInput();
+            std::this_thread::sleep_for(1ms);
+        }
+        std::cout << sink->moves << " moves in " << RUN.count() << " ms at one per "
+                  << PERIOD.count() << " ms\n";
+        ok &= check(sink->moves > 0 && sink->moves <= RUN / PERIOD + 1, "moves are paced");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../include/board-eval.hpp"
+#include "../include/placement-search.hpp"
+#include "../include/simulation.hpp"
+#include "../include/tetris-game-model.hpp"
+
+namespace {
+
+using board_eval::Features;
+using board_eval::Kernel;
+using placement_search::Board;
+
+constexpr std::size_t BOARDS_COUNT = 1024;
+constexpr auto MIN_BENCH_TIME = std::chrono::milliseconds(100);
+
+// cell by cell, the way the features are defined
+Features naiveFeatures(const Board& board) {
+    auto width = static_cast<int>(board.width());
+    auto height = static_cast<int>(board.height());
+    auto isBlock = [&](int x, int y) {
+        if (x < 0 || x >= width || y >= height) return true;
+        return board.test(x, y);
+    };
+
+    Features f;
+    std::vector<int> heights(width, 0);
+    for (int x = 0; x < width; ++x) {
+        int depth = 0;
+        bool isCovered = false;
+        for (int y = 0; y < height; ++y) {
+            if (isBlock(x, y)) {
+                if (!isCovered) heights[x] = height - y;
+                isCovered = true;
+            } else if (isCovered) {
+                ++f.holes;
+            }
+            if (isBlock(x, y) != isBlock(x, y + 1)) ++f.columnTransitions;
+            if (!isBlock(x, y) && isBlock(x - 1, y) && isBlock(x + 1, y)) {
+                f.wells += ++depth;
+            } else {
+                depth = 0;
+            }
+        }
+        f.aggregateHeight += heights[x];
+        if (x > 0) f.bumpiness += std::abs(heights[x] - heights[x - 1]);
+    }
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x <= width; ++x) {
+            if (isBlock(x - 1, y) != isBlock(x, y)) ++f.rowTransitions;
+        }
+    }
+    return f;
+}
+
+// stacks from random play, some of them high, all of them ragged
+std::vector<Board> makeBoards(std::size_t width, std::size_t height) {
+    std::vector<Board> boards;
+    for (std::uint64_t seed = 1; boards.size() < BOARDS_COUNT; ++seed) {
+        tetris_game_model::TetrisGameModel model(width, height, seed);
+        simulation::RandomPolicy policy(seed);
+        simulation::playGame(model, policy, seed % (width * height / 8) + 1);
+        boards.push_back(placement_search::lockedBoard(model));
+    }
+    return boards;
+}
+
+// boards a second, one thread
+template <typename F>
+double measure(F&& evaluateAll) {
+    std::size_t rounds = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::steady_clock::duration::zero();
+    do {
+        evaluateAll();
+        ++rounds;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed < MIN_BENCH_TIME);
+    return rounds * BOARDS_COUNT / std::chrono::duration<double>(elapsed).count();
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+    std::cout << "best kernel: " << board_eval::kernelName(board_eval::bestKernel()) << '\n';
+    for (auto [width, height] : {std::pair<std::size_t, std::size_t>{10, 20}, {21, 41}}) {
+        auto boards = makeBoards(width, height);
+        board_eval::BoardBatch batch(width, height);
+        for (const auto& board : boards) batch.add(board);
+
+        std::vector<Features> expected;
+        for (const auto& board : boards) expected.push_back(naiveFeatures(board));
+        volatile std::int32_t sink = 0;
+        auto naiveRate = measure([&] {
+            for (const auto& board : boards) sink = sink + naiveFeatures(board).holes;
+        });
+        std::cout << width << "x" << height << ": naive " << naiveRate / 1e6 << " M boards/s";
+
+        std::vector<Features> out(boards.size());
+        for (auto kernel : {Kernel::SCALAR, Kernel::SSE, Kernel::AVX2}) {
+            if (!board_eval::isSupported(kernel)) continue;
+            board_eval::evaluate(batch, out, kernel);
+            bool isSame = out == expected;
+            for (std::size_t i = 0; i < boards.size(); i += 97) {
+                isSame &= board_eval::evaluate(boards[i]) == expected[i];
+            }
+            if (!isSame) {
+                std::cerr << "FAILED: the " << board_eval::kernelName(kernel)
+                          << " kernel differs from the naive features\n";
+                ok = false;
+            }
+            auto rate = measure([&] { board_eval::evaluate(batch, out, kernel); });
+            std::cout << ", " << board_eval::kernelName(kernel) << " " << rate / 1e6
+                      << " M (x" << rate / naiveRate << ")";
+        }
+        std::cout << '\n';
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "../include/software-render-target.hpp"
+#include "../include/tetris-game-controller.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using observer_n_subject::EventType;
+
+// pressed from a thread of its own, never polled
+class FloodInput final : public player_input::IPlayerInput {
+public:
+    void pollInput() override {}
+    void press(EventType event) { notify(event); }
+};
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    auto grid = std::make_shared<view::DrawableGridCanvas>(51.f, 41.f, 10, 8, 1.f);
+    auto text = std::make_shared<view::DrawableText>("Your score:", 8, "");
+    auto stackL = std::make_shared<view::DrawableStackLayout>();
+    stackL->addComponent(grid, "grid");
+    stackL->addComponent(text, "score_text");
+    auto sz = stackL->size();
+
+    auto target = std::make_shared<render_target::SoftwareRenderTarget>(
+        static_cast<std::size_t>(sz.first), static_cast<std::size_t>(sz.second));
+    // short, so Down finishes the game quickly
+    auto model = std::make_shared<tetris_game_model::TetrisGameModel>(10, 8, 5);
+    auto input = std::make_shared<FloodInput>();
+    auto controller = std::make_shared<tetris_game_controller::TetrisGameController>(
+        model, input, target, stackL);
+    controller->registerAsObserver();
+
+    // keeps the queue full, so GAME_FINISH, raised on the loop's thread
+    // by a Down it handles, finds no room
+    std::atomic_bool isFlooding = true;
+    std::thread flood([&] {
+        while (isFlooding) input->press(EventType::USER_ASKED_DOWN);
+    });
+
+    std::atomic_bool isGameRun = true;
+    std::atomic_bool isGamePause = false;
+    std::mutex modelMut;
+    controller->runModel(modelMut, isGameRun, isGamePause);
+    isFlooding = false;
+    flood.join();
+
+    auto stats = controller->loopStats();
+    std::cout << stats.eventsHandled << " events handled, "
+              << stats.eventsDropped << " dropped\n";
+    ok &= check(model->isGameFinished() && !isGameRun, "the game finishes with a full queue");
+    ok &= check(stats.eventsDropped > 0, "input is dropped, not waited for");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../include/tetris-game-model.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using tetris_game_model::BlockType;
+using tetris_game_model::FieldSnapshot;
+using tetris_game_model::TetrisGameModel;
+
+// paints snapshots the way the controller does, into cells of its own
+struct Reader {
+    std::vector<BlockType> canvas;
+    std::uint64_t paintedSequence = 0;
+    std::uint64_t rowsPainted = 0;
+    std::uint64_t fullRepaints = 0;
+
+    void paint(const FieldSnapshot& snapshot) {
+        canvas.resize(snapshot.cells.size(), BlockType::VOID);
+        auto paintRow = [&](std::size_t y) {
+            auto first = snapshot.cells.begin() + y * snapshot.width;
+            std::copy(first, first + snapshot.width, canvas.begin() + y * snapshot.width);
+            ++rowsPainted;
+        };
+        if (snapshot.baseSequence <= paintedSequence) {
+            for (auto y : snapshot.dirtyRows) paintRow(y);
+        } else {
+            for (std::size_t y = 0; y < snapshot.height; ++y) paintRow(y);
+            ++fullRepaints;
+        }
+        paintedSequence = snapshot.sequence;
+    }
+};
+
+bool isFieldOf(const std::vector<BlockType>& cells, const TetrisGameModel& model) {
+    const auto& field = model.field();
+    for (std::size_t y = 0; y < field.size(); ++y) {
+        for (std::size_t x = 0; x < field[y].size(); ++x) {
+            if (cells[y * field[y].size() + x] != field[y][x]) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    {
+        tetris_game_model::FieldChangeSet changes(10, 4);
+        changes.markDirty(3, 1);
+        changes.markDirty(9, 2);
+        changes.markDirty(3, 1);
+        std::vector<std::size_t> cells;
+        changes.forEachDirtyCell([&](std::size_t x, std::size_t y) { cells.push_back(y * 10 + x); });
+        bool isMarked = cells == std::vector<std::size_t>{13, 29}
+            && changes.dirtyRows() == std::vector<std::size_t>{1, 2};
+        changes.reset();
+        bool isReset = changes.empty() && changes.dirtyRows().empty();
+        changes.forEachDirtyCell([&](std::size_t, std::size_t) { isReset = false; });
+        changes.markRowsDirty(2, 4);
+        std::size_t count = 0;
+        changes.forEachDirtyCell([&](std::size_t, std::size_t y) { count += y >= 2; });
+        ok &= check(isMarked && isReset && count == 20, "change set marks cells and rows");
+    }
+
+    // random input on one thread; the reader takes a snapshot now and then,
+    // so buffers it skipped come back to the writer with older contents
+    std::mt19937_64 rng(11);
+    Reader reader;
+    std::uint64_t publishes = 0;
+    std::uint64_t rowsCopied = 0;
+    bool isCurrent = true;
+    bool isPainted = true;
+    bool isReset = true;
+    std::size_t height = 0;
+    for (std::uint64_t game = 0; game < 20; ++game) {
+        TetrisGameModel model(10, 20, game + 1);
+        height = model.fieldHeight();
+        model.setSnapshotPublishing(true);
+        reader = Reader();
+        auto before = model.snapshotStats().published;
+        for (int step = 0; step < 2000 && !model.isGameFinished(); ++step) {
+            switch (rng() % 5) {
+                case 0: model.moveLeftTetromino(); break;
+                case 1: model.moveRightTetromino(); break;
+                case 2: model.rotateRightTetromino(); break;
+                case 3: model.updateModel(); break;
+                default: if (rng() % 4 == 0) model.hardDropTetromino(); break;
+            }
+            isReset &= model.changeSet().empty();
+            if (rng() % 3 != 0) continue;
+            const auto& snapshot = model.latestSnapshot();
+            isCurrent &= isFieldOf(snapshot.cells, model);
+            rowsCopied += snapshot.dirtyRows.size();
+            reader.paint(snapshot);
+            isPainted &= reader.canvas == snapshot.cells;
+        }
+        publishes += model.snapshotStats().published - before;
+    }
+    std::cout << publishes << " snapshots, " << rowsCopied / static_cast<double>(publishes)
+              << " rows copied per snapshot of " << height << ", "
+              << reader.fullRepaints << " full repaints in the last game\n";
+    ok &= check(isCurrent, "the newest snapshot is the field");
+    ok &= check(isReset, "publishing resets the change set");
+    ok &= check(isPainted, "repainting the dirty rows keeps a reader current");
+    ok &= check(rowsCopied * 4 < publishes * height, "only changed rows are copied");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../include/tetromino.hpp"
+#include "../include/tetromino-movement.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using tetris_game_model::BlockType;
+using tetrominoes::Block;
+using tetrominoes::Tetromino;
+using field_t = std::vector<std::vector<BlockType>>;
+
+bool isLocked(const field_t& field, const Tetromino& tetromino, int x, int y) {
+    auto block = field[y][x];
+    return block != BlockType::VOID && block != BlockType::GHOST
+        && !tetromino.containsBlock({x, y});
+}
+
+// how far the tetromino falls, a row at a time
+int blockByBlockDrop(const field_t& field, const Tetromino& tetromino) {
+    for (int dy = 0;; ++dy) {
+        for (auto b : tetromino.shape()) {
+            int y = b.second + dy + 1;
+            if (y >= static_cast<int>(field.size()) || isLocked(field, tetromino, b.first, y)) {
+                return dy;
+            }
+        }
+    }
+}
+
+// a locked block above the tetromino in one of its columns
+bool isUnderOverhang(const field_t& field, const Tetromino& tetromino) {
+    for (auto b : tetromino.shape()) {
+        for (int y = 0; y < b.second; ++y) {
+            if (isLocked(field, tetromino, b.first, y)) return true;
+        }
+    }
+    return false;
+}
+
+bool isGhostAt(const field_t& field, const Tetromino& tetromino, int dy) {
+    std::size_t ghostBlocks = 0;
+    for (const auto& row : field) ghostBlocks += std::count(row.begin(), row.end(), BlockType::GHOST);
+    std::size_t expected = 0;
+    for (auto b : tetromino.shape()) {
+        Block ghost {b.first, b.second + dy};
+        if (tetromino.containsBlock(ghost)) continue;
+        ++expected;
+        if (field[ghost.second][ghost.first] != BlockType::GHOST) return false;
+    }
+    return ghostBlocks == expected;
+}
+
+std::size_t deleteFullLines(field_t& field, tetromino_movement::TetrominoMovement& movement) {
+    std::vector<std::size_t> rows;
+    for (std::size_t y = 0; y < field.size(); ++y) {
+        if (std::ranges::none_of(field[y], [](auto b) { return b == BlockType::VOID; })) {
+            rows.push_back(y);
+        }
+    }
+    if (rows.empty()) return 0;
+    for (auto y : rows) {
+        field.erase(field.begin() + y);
+        field.insert(field.begin(), std::vector<BlockType>(field.back().size(), BlockType::VOID));
+    }
+    movement.linesDeleted(rows);
+    return rows.size();
+}
+
+struct Drops {
+    std::size_t ghosts = 0;
+    std::size_t hardDrops = 0;
+    std::size_t overhangs = 0;
+    std::size_t lines = 0;
+    bool isSame = true;
+};
+
+// random play that slides tetrominoes sideways low in the stack, so
+// it turns ragged and overhangs form; every ghost and every hard drop
+// is compared with the block by block drop
+Drops play(tetromino_movement::TetrominoMovement& movement,
+           std::size_t width, std::size_t height, std::uint64_t seed) {
+    auto field = std::make_shared<field_t>(height, std::vector<BlockType>(width, BlockType::VOID));
+    movement.setField(field);
+    std::mt19937_64 gen(seed);
+    tetrominoes::TetrominoGenerator tetrominoes(seed);
+    Drops drops;
+    for (int piece = 0; piece < 3000; ++piece) {
+        auto tetromino = tetrominoes.next();
+        auto shift = gen() % (width - tetromino.greatestSide() + 1);
+        for (std::size_t i = 0; i < shift; ++i) tetromino.moveRightOneSquare();
+        if (!movement.setTetromino(tetromino)) {
+            for (auto& row : *field) std::fill(row.begin(), row.end(), BlockType::VOID);
+            movement.setField(field);
+            continue;
+        }
+        for (bool isFalling = true; isFalling;) {
+            const auto& cur = movement.tetromino();
+            auto dy = blockByBlockDrop(*field, cur);
+            drops.isSame &= isGhostAt(*field, cur, dy);
+            ++drops.ghosts;
+            drops.overhangs += isUnderOverhang(*field, cur);
+            switch (gen() % 6) {
+                case 0: movement.rotateRight(); break;
+                case 1: movement.moveLeft(); break;
+                case 2: movement.moveRight(); break;
+                case 3: {
+                    auto dropped = cur;
+                    dropped.moveDownSquares(dy);
+                    drops.isSame &= movement.hardDrop() == (dy > 0)
+                        && std::ranges::equal(movement.tetromino().shape(), dropped.shape());
+                    ++drops.hardDrops;
+                    isFalling = false;
+                    break;
+                }
+                default: isFalling = movement.moveDown(); break;
+            }
+        }
+        movement.lockTetromino();
+        // the height map follows the deleted lines
+        drops.lines += deleteFullLines(*field, movement);
+    }
+    return drops;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    for (int engine = 0; engine < 2; ++engine) {
+        tetromino_movement::TetrominoMovementWithGhostTetromino ghostMovement;
+        tetromino_movement::BitboardTetrominoMovement bitboardMovement;
+        auto& movement = engine == 0
+            ? static_cast<tetromino_movement::TetrominoMovement&>(ghostMovement)
+            : bitboardMovement;
+        const char* name = engine == 0
+            ? "TetrominoMovementWithGhostTetromino" : "BitboardTetrominoMovement";
+        Drops total;
+        for (std::uint64_t seed = 1; seed <= 3; ++seed) {
+            for (std::size_t width : {5, 8, 10}) {
+                auto drops = play(movement, width, 16, seed);
+                total.isSame &= drops.isSame;
+                total.ghosts += drops.ghosts;
+                total.hardDrops += drops.hardDrops;
+                total.overhangs += drops.overhangs;
+                total.lines += drops.lines;
+            }
+        }
+        std::cout << name << ": " << total.ghosts << " ghosts, " << total.hardDrops
+                  << " hard drops, " << total.overhangs << " under an overhang, "
+                  << total.lines << " lines\n";
+        ok &= check(total.isSame, "the ghost and the hard drop land where the tetromino falls");
+        ok &= check(total.overhangs > 50 && total.lines > 100,
+                    "tetrominoes slide under overhangs and clear lines");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "../include/gravity-scheduler.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using namespace std::chrono_literals;
+using namespace gravity_scheduler;
+
+// moves only when told to; the scheduler polls it, so a notify missed
+// between a move and the wait costs a millisecond, never a tick
+class ManualClock final : public Clock {
+public:
+    time_point_t now() const override {
+        return now_.load();
+    }
+
+    bool waitUntil(
+        std::unique_lock<std::mutex>& lk, std::condition_variable& cv,
+        time_point_t deadline, const std::function<bool()>& ready) override {
+        for (;;) {
+            // read before the checks, so a move after them is seen next time
+            auto generation = generation_.load();
+            if (ready()) return true;
+            if (now() >= deadline) return false;
+            seenGeneration_.store(generation);
+            cv.wait_for(lk, 1ms);
+        }
+    }
+
+    // from the scheduler's thread, e.g. a tick that takes a while
+    void skip(duration_t d) {
+        now_.store(now_.load() + d);
+    }
+
+    void advance(duration_t d) {
+        skip(d);
+        settle();
+    }
+
+    // returns once the scheduler waits again, having seen everything
+    // done before the call
+    void settle() {
+        auto generation = ++generation_;
+        while (seenGeneration_.load() < generation) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    std::atomic<time_point_t> now_ {time_point_t{} + 1h};
+    std::atomic<std::uint64_t> generation_ = 0;
+    std::atomic<std::uint64_t> seenGeneration_ = 0;
+};
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    GuidelineGravityCurve guideline;
+    ok &= check(guideline.period(1) == 1s, "guideline level 1 is one second");
+    ok &= check(guideline.period(10) < guideline.period(9), "guideline speeds up");
+
+    auto clock = std::make_shared<ManualClock>();
+    std::atomic<int> ticks = 0;
+    std::atomic<duration_t> tickCost {3ms};
+    GravityScheduler scheduler(
+        [&] {
+            ++ticks;
+            clock->skip(tickCost);
+        },
+        std::make_shared<ConstantGravityCurve>(10ms), 1, 20, clock);
+
+    std::thread t([&] { scheduler.run(); });
+    clock->settle();
+
+    clock->advance(9ms);
+    bool isOnDeadline = ticks == 0;
+    clock->advance(1ms);
+    isOnDeadline &= ticks == 1 && scheduler.tickStats().lastLateness == 0ms;
+    ok &= check(isOnDeadline, "a tick fires on its deadline");
+
+    // the first tick took 3 ms, the second is still 10 ms after the first
+    clock->advance(7ms);
+    ok &= check(ticks == 2 && scheduler.tickStats().lastLateness == 0ms,
+                "a slow tick does not push back the next one");
+
+    // 48 ms: the tick due at 30 is 18 ms late and ends at 51, past the
+    // deadlines at 40 and 50
+    clock->advance(25ms);
+    auto stats = scheduler.tickStats();
+    ok &= check(ticks == 3 && stats.lastLateness == 18ms && stats.skippedTicks == 2,
+                "ticks overrun by a late one are skipped");
+
+    // paused at 51 with 9 ms left until 60
+    scheduler.pause();
+    clock->settle();
+    clock->advance(1s);
+    bool isPaused = ticks == 3;
+    scheduler.resume();
+    clock->settle();
+    clock->advance(8ms);
+    isPaused &= ticks == 3;
+    clock->advance(1ms);
+    isPaused &= ticks == 4 && scheduler.tickStats().lastLateness == 0ms;
+    ok &= check(isPaused, "no ticks while paused, the rest of the period after");
+
+    tickCost = 0ms;
+    scheduler.setSoftDrop(true);
+    clock->settle();
+    bool isSoftDrop = true;
+    for (int i = 0; i < 20; ++i) {
+        clock->advance(500us);
+        isSoftDrop &= ticks == 5 + i;
+    }
+    ok &= check(isSoftDrop, "soft drop ticks 20 times as often");
+
+    scheduler.stop();
+    t.join();
+
+    stats = scheduler.tickStats();
+    ok &= check(stats.ticks == static_cast<std::uint64_t>(ticks.load()), "every tick is counted");
+    std::cout << "ticks " << stats.ticks
+              << ", skipped " << stats.skippedTicks
+              << ", mean lateness " << std::chrono::duration<double, std::micro>(stats.meanLateness()).count() << " us"
+              << ", max lateness " << std::chrono::duration<double, std::micro>(stats.maxLateness).count() << " us\n";
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "../include/lookahead-bot.hpp"
+#include "../include/task-pool.hpp"
+#include "../include/tetris-game-model.hpp"
+#include "../include/tetromino.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using tetris_game_model::BlockType;
+using tetris_game_model::TetrisGameModel;
+using tetrominoes::Tetromino;
+using field_t = TetrisGameModel::field_t;
+
+bool isFree(const field_t& field, int x, int y) {
+    return y < static_cast<int>(field.size()) && field[y][x] == BlockType::VOID;
+}
+
+// the model's field with the falling tetromino and its ghost left out
+field_t lockedField(const TetrisGameModel& model) {
+    auto field = model.field();
+    for (std::size_t y = 0; y < field.size(); ++y) {
+        for (std::size_t x = 0; x < field[y].size(); ++x) {
+            auto& block = field[y][x];
+            bool isFalling = !model.isGameFinished() && model.currentTetromino().containsBlock(
+                {static_cast<int>(x), static_cast<int>(y)});
+            if (block == BlockType::GHOST || isFalling) block = BlockType::VOID;
+        }
+    }
+    return field;
+}
+
+struct Naive {
+    field_t field;
+    std::vector<std::size_t> deletedRows;
+    std::size_t stackTop;
+};
+
+// drops the tetromino a row at a time and erases full rows one by one,
+// inserting empty ones on top
+void dropNLock(Naive& naive, Tetromino tetromino) {
+    auto& field = naive.field;
+    auto fits = [&](int dy) {
+        return std::ranges::all_of(tetromino.shape(), [&](auto b) {
+            return isFree(field, b.first, b.second + dy);
+        });
+    };
+    int dy = 0;
+    while (fits(dy + 1)) ++dy;
+    tetromino.moveDownSquares(dy);
+    for (auto b : tetromino.shape()) {
+        field[b.second][b.first] = static_cast<BlockType>(tetromino.type());
+    }
+
+    naive.deletedRows.clear();
+    for (std::size_t y = 0; y < field.size(); ++y) {
+        if (std::ranges::none_of(field[y], [](auto b) { return b == BlockType::VOID; })) {
+            naive.deletedRows.push_back(y);
+        }
+    }
+    for (auto y : naive.deletedRows) {
+        field.erase(field.begin() + y);
+        field.insert(field.begin(), std::vector<BlockType>(field.back().size(), BlockType::VOID));
+    }
+    naive.stackTop = field.size();
+    for (std::size_t y = field.size(); y-- > 0;) {
+        if (std::ranges::any_of(field[y], [](auto b) { return b != BlockType::VOID; })) {
+            naive.stackTop = y;
+        }
+    }
+}
+
+struct Clears {
+    std::size_t pieces = 0;
+    std::size_t lines = 0;
+    // full rows with a row left in between
+    std::size_t splitClears = 0;
+    bool isSame = true;
+};
+
+// the bot one tetromino deep keeps the game going and leaves holes
+// behind, so rows apart fill up now and then
+Clears play(task_pool::TaskPool& pool, std::size_t width, std::size_t height,
+            std::uint64_t seed, std::size_t pieces) {
+    TetrisGameModel model(width, height, seed);
+    lookahead_bot::LookaheadPolicy policy(pool, {}, {1, 1, 0});
+    Naive naive {lockedField(model), {}, height};
+    Clears clears;
+    for (; clears.pieces < pieces && !model.isGameFinished() && clears.isSame; ++clears.pieces) {
+        policy.placeTetromino(model);
+        dropNLock(naive, model.currentTetromino());
+        model.hardDropTetromino();
+        clears.isSame &= lockedField(model) == naive.field
+            && model.deletedRows() == naive.deletedRows
+            && model.stackTop() == naive.stackTop;
+        const auto& rows = naive.deletedRows;
+        clears.lines += rows.size();
+        clears.splitClears += std::adjacent_find(rows.begin(), rows.end(), [](auto a, auto b) {
+            return b != a + 1;
+        }) != rows.end();
+    }
+    return clears;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    task_pool::TaskPool pool(1);
+    Clears total;
+    for (std::uint64_t seed = 1; seed <= 6; ++seed) {
+        for (std::size_t width : {8, 10, 12}) {
+            auto clears = play(pool, width, 20, seed, 1000);
+            if (!clears.isSame) {
+                std::cerr << width << " wide, seed " << seed
+                          << ": the model differs after tetromino " << clears.pieces << '\n';
+            }
+            total.isSame &= clears.isSame;
+            total.pieces += clears.pieces;
+            total.lines += clears.lines;
+            total.splitClears += clears.splitClears;
+        }
+    }
+    ok &= check(total.isSame, "the field, the deleted rows and the stack top match erase and insert");
+    ok &= check(total.splitClears > 10, "rows apart are cleared at once");
+    std::cout << total.pieces << " tetrominoes, " << total.lines << " lines, "
+              << total.splitClears << " clears of rows apart\n";
+
+    return ok ? 0 : 1;
+}
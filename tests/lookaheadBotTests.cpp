@@ -0,0 +1,159 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stop_token>
+#include <thread>
+
+#include "../include/board-eval.hpp"
+#include "../include/lookahead-bot.hpp"
+#include "../include/placement-search.hpp"
+#include "../include/simulation.hpp"
+#include "../include/task-pool.hpp"
+#include "../include/tetris-game-model.hpp"
+#include "../include/tetromino.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using placement_search::Board;
+using placement_search::Placement;
+using tetrominoes::TetrominoType;
+
+// nested groups all the way down, the sum of 0 .. n - 1
+std::uint64_t sumRange(task_pool::TaskPool& pool, std::uint64_t from, std::uint64_t to) {
+    if (to - from <= 64) {
+        std::uint64_t sum = 0;
+        for (auto i = from; i < to; ++i) sum += i;
+        return sum;
+    }
+    std::uint64_t left = 0;
+    std::uint64_t right = 0;
+    auto mid = from + (to - from) / 2;
+    task_pool::TaskGroup group(pool);
+    group.run([&] { left = sumRange(pool, from, mid); });
+    group.run([&] { right = sumRange(pool, mid, to); });
+    group.wait();
+    return left + right;
+}
+
+simulation::GameResult playBot(
+    task_pool::TaskPool& pool, std::uint64_t seed, std::uint64_t pieces,
+    lookahead_bot::SearchOptions options) {
+    tetris_game_model::TetrisGameModel model(10, 20, seed);
+    lookahead_bot::LookaheadPolicy policy(pool, {}, options);
+    return simulation::playGame(model, policy, pieces);
+}
+
+} // namespace
+
+int main() {
+    using namespace std::chrono_literals;
+    bool ok = true;
+    task_pool::TaskPool pool(4);
+
+    {
+        constexpr std::uint64_t N = 1 << 16;
+        bool isSummed = sumRange(pool, 0, N) == N * (N - 1) / 2;
+        task_pool::TaskPool single(1);
+        isSummed &= sumRange(single, 0, N) == N * (N - 1) / 2;
+        ok &= check(isSummed && single.tasksStolen() == 0, "nested groups finish");
+    }
+
+    {
+        // an I in the well clears four lines
+        Board board(10, 20);
+        for (std::size_t y = 16; y < 20; ++y) {
+            for (std::size_t x = 0; x < 9; ++x) board.set(x, y);
+        }
+        auto deleted = board.lock(TetrominoType::I, Placement{9, 16, 1, 0});
+        bool isEmpty = true;
+        for (std::size_t x = 0; x < 10; ++x) isEmpty &= !board.test(x, 19);
+        ok &= check(deleted == 4 && isEmpty, "lock deletes full lines");
+    }
+
+    {
+        // heights 2 and 1 with a hole under the taller column
+        Board board(4, 6);
+        board.set(0, 4);
+        board.set(1, 5);
+        lookahead_bot::Weights weights {1.0, 0.0, 10.0, 100.0};
+        auto value = lookahead_bot::evaluateBoard(board, weights);
+        ok &= check(value == 3.0 + 10.0 + 100.0 * 2, "board features");
+    }
+
+    {
+        lookahead_bot::LookaheadSearch search(pool);
+        Board board(10, 20);
+        for (std::size_t y = 16; y < 20; ++y) {
+            for (std::size_t x = 0; x < 9; ++x) board.set(x, y);
+        }
+        auto t = lookahead_bot::spawnedTetromino(TetrominoType::I, 10);
+        auto decision = search.decide(board, t);
+        ok &= check(decision.depth == 3 && decision.placement.column == 9
+                    && decision.placement.rotation % 2 == 1, "takes the tetris");
+
+        // asked to stop before it started, only the first tetromino is searched
+        std::stop_source stopped;
+        stopped.request_stop();
+        ok &= check(search.decide(board, t, stopped.get_token()).depth == 1,
+                    "a stopped search keeps the first depth");
+    }
+
+    {
+        // too tall for the batched kernel, the same tetris with the scalar one
+        constexpr std::size_t HEIGHT = board_eval::BoardBatch::MAX_HEIGHT + 13;
+        lookahead_bot::LookaheadSearch search(pool);
+        Board board(10, HEIGHT);
+        for (std::size_t y = HEIGHT - 4; y < HEIGHT; ++y) {
+            for (std::size_t x = 0; x < 9; ++x) board.set(x, y);
+        }
+        auto decision = search.decide(board, lookahead_bot::spawnedTetromino(TetrominoType::I, 10));
+        ok &= check(decision.placement.column == 9 && decision.placement.rotation % 2 == 1,
+                    "searches boards taller than a batch");
+    }
+
+    {
+        // far too deep to finish, stopped by another thread like gravity does
+        lookahead_bot::LookaheadSearch search(pool, {}, {6, 16});
+        std::stop_source stop;
+        std::thread timer([&] {
+            std::this_thread::sleep_for(20ms);
+            stop.request_stop();
+        });
+        auto start = std::chrono::steady_clock::now();
+        auto decision = search.decide(
+            Board(10, 20), lookahead_bot::spawnedTetromino(TetrominoType::T, 10), stop.get_token());
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        timer.join();
+        ok &= check(decision.depth >= 1 && decision.depth < 6 && elapsed < 500ms,
+                    "stops soon after it is asked to");
+        std::cout << "stopped at depth " << decision.depth << " after "
+                  << std::chrono::duration<double, std::milli>(elapsed).count() << " ms, "
+                  << pool.tasksStolen() << " tasks stolen\n";
+    }
+
+    {
+        // the same game on one thread and on four
+        constexpr std::uint64_t PIECES = 60;
+        constexpr lookahead_bot::SearchOptions OPTIONS {2, 8};
+        task_pool::TaskPool single(1);
+        auto start = std::chrono::steady_clock::now();
+        auto res = playBot(pool, 5, PIECES, OPTIONS);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        auto same = playBot(single, 5, PIECES, OPTIONS);
+        ok &= check(!res.isFinished && res.pieces == PIECES && res.lines >= 15,
+                    "the bot survives and clears lines");
+        ok &= check(res.lines == same.lines && res.score == same.score,
+                    "the same game whatever the threads");
+        std::cout << res.lines << " lines in " << res.pieces << " pieces, "
+                  << std::chrono::duration<double, std::milli>(elapsed).count() / PIECES
+                  << " ms per piece at depth " << OPTIONS.depth << " on "
+                  << pool.threadCount() << " threads\n";
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "../include/tetromino.hpp"
+#include "../include/tetromino-movement.hpp"
+#include "allocation-counter.hpp"
+
+namespace {
+
+using tetris_game_model::BlockType;
+using field_t = std::vector<std::vector<BlockType>>;
+
+constexpr std::size_t FIELD_WIDTH = 21;
+constexpr std::size_t FIELD_HEIGHT = 41;
+
+tetrominoes::Tetromino spawnTetromino() {
+    auto tetromino = tetrominoes::getRandomTetromino();
+    for (std::size_t i = 0; i < FIELD_WIDTH / 2; ++i) {
+        tetromino.moveRightOneSquare();
+    }
+    return tetromino;
+}
+
+// drives the movement like TetrisGameModel does, clearing the field 
+// instead of deleting lines so the game never ends
+void playMoves(tetromino_movement::TetrominoMovement& movement, 
+               std::shared_ptr<field_t> field,
+               int pieces) 
+{
+    for (int i = 0; i < pieces; ++i) {
+        if (!movement.setTetromino(spawnTetromino())) {
+            for (auto& row : *field) {
+                std::fill(row.begin(), row.end(), BlockType::VOID);
+            }
+            continue;
+        }
+        for (int step = 0; movement.moveDown(); ++step) {
+            switch (step % 4) {
+                case 0: movement.rotateRight(); break;
+                case 1: movement.moveLeft(); break;
+                case 2: movement.moveRight(); break;
+                case 3: movement.moveRight(); break;
+            }
+        }
+    }
+}
+
+bool checkNoAllocations(
+    const char* name, tetromino_movement::TetrominoMovement& movement) 
+{
+    auto field = std::make_shared<field_t>(
+        FIELD_HEIGHT, std::vector<BlockType>(FIELD_WIDTH, BlockType::VOID));
+    movement.setField(field);
+    // warm up: lets lazily sized buffers reach their steady size
+    playMoves(movement, field, 10);
+
+    auto before = allocation_counter::allocationsCount.load();
+    playMoves(movement, field, 1000);
+    auto allocations = allocation_counter::allocationsCount.load() - before;
+
+    std::cout << name << ": " << allocations << " allocations" << std::endl;
+    return allocations == 0;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    tetromino_movement::TetrominoMovementWithGhostTetromino ghostMovement;
+    ok &= checkNoAllocations("TetrominoMovementWithGhostTetromino", ghostMovement);
+
+    tetromino_movement::BitboardTetrominoMovement bitboardMovement;
+    ok &= checkNoAllocations("BitboardTetrominoMovement", bitboardMovement);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../include/tetromino.hpp"
+#include "../include/tetromino-movement.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using tetris_game_model::BlockType;
+using field_t = std::vector<std::vector<BlockType>>;
+
+struct Engine {
+    tetromino_movement::TetrominoMovement& movement;
+    std::shared_ptr<field_t> field;
+};
+
+bool isFullRow(const std::vector<BlockType>& row) {
+    return std::none_of(row.begin(), row.end(), [](auto block) {
+        return block == BlockType::VOID || block == BlockType::GHOST;
+    });
+}
+
+// deletes full rows like the model does, but by erasing and inserting them
+void deleteFullLines(Engine& engine) {
+    auto& field = *engine.field;
+    std::vector<std::size_t> rows;
+    for (std::size_t y = 0; y < field.size(); ++y) {
+        if (isFullRow(field[y])) rows.push_back(y);
+    }
+    if (rows.empty()) return;
+    for (auto y : rows) {
+        field.erase(field.begin() + y);
+        field.insert(field.begin(), std::vector<BlockType>(field.back().size(), BlockType::VOID));
+    }
+    engine.movement.linesDeleted(rows);
+}
+
+void restart(Engine& engine) {
+    for (auto& row : *engine.field) std::fill(row.begin(), row.end(), BlockType::VOID);
+    engine.movement.setField(engine.field);
+}
+
+struct Run {
+    std::size_t calls = 0;
+    std::size_t lines = 0;
+    std::size_t games = 0;
+    bool isSame = true;
+};
+
+// one seeded sequence of calls on both engines, the fields and the
+// results compared after every call
+Run playSideBySide(std::size_t width, std::size_t height, std::uint64_t seed, std::size_t calls) {
+    auto makeField = [&] {
+        return std::make_shared<field_t>(height, std::vector<BlockType>(width, BlockType::VOID));
+    };
+    tetromino_movement::TetrominoMovementWithGhostTetromino ghostMovement;
+    tetromino_movement::BitboardTetrominoMovement bitboardMovement;
+    Engine ghost {ghostMovement, makeField()};
+    Engine bitboard {bitboardMovement, makeField()};
+    restart(ghost);
+    restart(bitboard);
+
+    std::mt19937_64 gen(seed);
+    tetrominoes::TetrominoGenerator tetrominoes(seed);
+    Run run;
+    bool isFalling = false;
+    auto same = [&](bool a, bool b) {
+        run.isSame &= a == b && *ghost.field == *bitboard.field
+            && std::ranges::equal(ghost.movement.tetromino().shape(),
+                                  bitboard.movement.tetromino().shape());
+        return a;
+    };
+    auto lock = [&] {
+        ghost.movement.lockTetromino();
+        bitboard.movement.lockTetromino();
+        same(true, true);
+        run.lines += std::count_if(ghost.field->begin(), ghost.field->end(), isFullRow);
+        deleteFullLines(ghost);
+        deleteFullLines(bitboard);
+        same(true, true);
+        isFalling = false;
+    };
+
+    for (; run.calls < calls && run.isSame; ++run.calls) {
+        if (!isFalling) {
+            auto tetromino = tetrominoes.next();
+            auto shift = gen() % (width - tetromino.greatestSide() + 1);
+            for (std::size_t i = 0; i < shift; ++i) tetromino.moveRightOneSquare();
+            isFalling = same(ghost.movement.setTetromino(tetromino),
+                             bitboard.movement.setTetromino(tetromino));
+            if (!isFalling) {
+                restart(ghost);
+                restart(bitboard);
+                ++run.games;
+            }
+            continue;
+        }
+        switch (gen() % 8) {
+            case 0: same(ghost.movement.rotateRight(), bitboard.movement.rotateRight()); break;
+            case 1: same(ghost.movement.moveLeft(), bitboard.movement.moveLeft()); break;
+            case 2: same(ghost.movement.moveRight(), bitboard.movement.moveRight()); break;
+            case 3:
+                same(ghost.movement.hardDrop(), bitboard.movement.hardDrop());
+                lock();
+                break;
+            default:
+                if (!same(ghost.movement.moveDown(), bitboard.movement.moveDown())) lock();
+                break;
+        }
+    }
+    return run;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    struct Size { std::size_t width; std::size_t height; };
+    constexpr Size SIZES[] = {{4, 12}, {6, 16}, {10, 20}, {21, 41},
+        {tetromino_movement::BitboardTetrominoMovement::MAX_FIELD_WIDTH, 24}};
+    Run total;
+    for (std::uint64_t seed = 1; seed <= 4; ++seed) {
+        for (auto [width, height] : SIZES) {
+            auto run = playSideBySide(width, height, seed, 20000);
+            if (!run.isSame) {
+                std::cerr << width << 'x' << height << ", seed " << seed
+                          << ": the engines differ after call " << run.calls << '\n';
+            }
+            total.isSame &= run.isSame;
+            total.calls += run.calls;
+            total.lines += run.lines;
+            total.games += run.games;
+        }
+    }
+    ok &= check(total.isSame, "both engines leave the same field after every call");
+    ok &= check(total.lines > 100 && total.games > 10, "the calls clear lines and end games");
+    std::cout << total.calls << " calls, " << total.lines << " lines, "
+              << total.games << " games\n";
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/perf-stats.hpp"
+#include "../include/view.hpp"
+#include "allocation-counter.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+// keeps the text of the last frame, drops everything else
+class TextTarget final : public render_target::IRenderTarget {
+public:
+    sf::Vector2u size() const override { return {200, 200}; }
+    void clear(sf::Color) override { count = 0; }
+    void fillRect(sf::FloatRect, sf::Color) override {}
+    void drawTriangles(std::span<const sf::Vertex>, sf::Vector2f) override {}
+    void drawText(const render_target::TextRun& text) override {
+        if (count < lines.size()) lines[count].assign(text.text);
+        ++count;
+    }
+    void display() override {}
+    std::unique_ptr<render_target::IRenderLayer> createLayer(sf::Vector2u) override {
+        return nullptr;
+    }
+    void drawLayer(render_target::IRenderLayer&, sf::Vector2f) override {}
+
+    // sized up front, assign() below reuses the capacity
+    std::vector<std::string> lines = std::vector<std::string>(
+        view::DrawablePerfHud::LINE_COUNT, std::string(64, ' '));
+    std::size_t count = 0;
+};
+
+} // namespace
+
+int main() {
+    using namespace std::chrono_literals;
+    bool ok = true;
+
+    {
+        perf_stats::RollingSamples<100> samples;
+        ok &= check(samples.percentiles().count == 0, "no samples yet");
+        for (int i = 1; i <= 100; ++i) samples.record(i);
+        auto p = samples.percentiles();
+        ok &= check(p.count == 100 && p.p50 == 50 && p.p99 == 99 && p.max == 100,
+                    "percentiles of 1..100");
+        // the window rolls over, only the last 100 count
+        for (int i = 0; i < 100; ++i) samples.record(7);
+        p = samples.percentiles();
+        ok &= check(p.p50 == 7 && p.max == 7, "old samples roll out");
+    }
+
+    {
+        // four threads at once, every slot ends up holding one of their values
+        perf_stats::RollingSamples<256> samples;
+        std::vector<std::thread> writers;
+        for (int t = 1; t <= 4; ++t) {
+            writers.emplace_back([&, t] {
+                for (int i = 0; i < 100'000; ++i) samples.record(t);
+            });
+        }
+        for (auto& w : writers) w.join();
+        auto p = samples.percentiles();
+        ok &= check(p.count == 256 && p.max <= 4 && p.p50 >= 1, "concurrent recording");
+    }
+
+    auto stats = std::make_shared<perf_stats::PerfStats>();
+    view::DrawablePerfHud hud(stats, 8);
+    TextTarget target;
+    auto draw = [&] {
+        target.clear(sf::Color::White);
+        hud.draw(target, {0.f, 0.f});
+    };
+
+    auto sizeBefore = hud.size();
+    stats->frameTime.record(1500us);
+    stats->inputLatency.record(250ms);
+    for (int i = 0; i < 10; ++i) stats->queueDepth.record(i);
+    stats->lockWait.record(3h);
+    draw();
+    ok &= check(target.count == view::DrawablePerfHud::LINE_COUNT, "one text run per line");
+    std::cout << target.lines[0] << '\n' << target.lines[1] << '\n'
+              << target.lines[3] << '\n' << target.lines[4] << '\n'
+              << target.lines[5] << '\n';
+    ok &= check(target.lines[1] == "frame     1.500    1.500    1.500 ms", "frame line");
+    ok &= check(target.lines[3] == "input   250.000  250.000  250.000 ms", "long stalls fit");
+    ok &= check(target.lines[4] == "queue         4        9        9   ", "counts have no unit");
+    ok &= check(target.lines[5] == "lock  >9999.999>9999.999>9999.999 ms", "values too wide are marked");
+    ok &= check(hud.size() == sizeBefore, "size never changes");
+
+    // sampling and drawing do not allocate
+    auto allocationsBefore = allocation_counter::allocationsCount.load();
+    for (int i = 0; i < 1000; ++i) {
+        stats->frameTime.record(std::chrono::microseconds(i));
+        stats->lockWait.record(std::chrono::nanoseconds(i));
+        draw();
+    }
+    ok &= check(allocation_counter::allocationsCount == allocationsBefore, "no allocations");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "../include/placement-search.hpp"
+#include "../include/simulation.hpp"
+#include "../include/tetris-game-model.hpp"
+#include "../include/tetromino.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using placement_search::Board;
+using placement_search::Move;
+using placement_search::PlacementSearch;
+using tetrominoes::Tetromino;
+
+using state_key_t = std::tuple<int, int, int>;
+
+// the rules of TetrominoMovementWithGhostTetromino, block by block
+bool fitsAt(const Board& board, const Tetromino& t) {
+    for (auto b : t.shape()) {
+        if (b.first < 0 || b.second < 0 || b.first >= static_cast<int>(board.width())
+            || b.second >= static_cast<int>(board.height())
+            || board.test(b.first, b.second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::set<state_key_t> referenceSearch(const Board& board, const Tetromino& start) {
+    auto key = [](const Tetromino& t) {
+        return state_key_t{t.leftmostPointOnX(), t.highestPointOnY(), static_cast<int>(t.rotation())};
+    };
+    std::set<state_key_t> seen {key(start)};
+    std::set<state_key_t> res;
+    std::deque<Tetromino> queue {start};
+    auto push = [&](const Tetromino& t) {
+        if (fitsAt(board, t) && seen.insert(key(t)).second) queue.push_back(t);
+    };
+    while (!queue.empty()) {
+        auto t = queue.front();
+        queue.pop_front();
+        auto down = t;
+        down.moveDownOneSquare();
+        if (fitsAt(board, down)) push(down); else res.insert(key(t));
+        auto left = t;
+        left.moveLeftOneSquare();
+        push(left);
+        auto right = t;
+        right.moveRightOneSquare();
+        push(right);
+        auto rotated = t;
+        rotated.rotateRigth();
+        if (rotated.rightmostPointOnX() < static_cast<int>(board.width()) - 1
+            && rotated.lowestPointOnY() < static_cast<int>(board.height()) - 1) {
+            push(rotated);
+        }
+    }
+    return res;
+}
+
+// a game with pieces tetrominoes already dropped, replayed the same for a seed
+struct Game {
+    Game(std::uint64_t seed, std::uint64_t pieces) :
+        model(10, 20, seed)
+        , policy(seed)
+    {
+        simulation::playGame(model, policy, pieces);
+    }
+
+    tetris_game_model::TetrisGameModel model;
+    simulation::RandomPolicy policy;
+};
+
+} // namespace
+
+int main() {
+    using namespace std::chrono_literals;
+    bool ok = true;
+    PlacementSearch search;
+
+    {
+        // an O slides under a ledge only from the open column beside it
+        Board board(10, 20);
+        for (std::size_t x = 0; x < 7; ++x) board.set(x, 17);
+        auto placements = search.search(board, Tetromino(tetrominoes::TetrominoType::O));
+        bool isTucked = std::any_of(placements.begin(), placements.end(), [](auto p) {
+            return p.column == 2 && p.row == 18;
+        });
+        bool isOnLedge = std::any_of(placements.begin(), placements.end(), [](auto p) {
+            return p.column == 2 && p.row == 15;
+        });
+        ok &= check(isTucked && isOnLedge, "tucks under an overhang");
+    }
+
+    // the same placements as a block by block search on boards from real games
+    std::size_t searches = 0;
+    std::size_t placementsFound = 0;
+    bool isSame = true;
+    for (std::uint64_t seed = 1; seed <= 30; ++seed) {
+        Game game(seed, 12);
+        if (game.model.isGameFinished()) continue;
+        auto board = placement_search::lockedBoard(game.model);
+        const auto& tetromino = game.model.currentTetromino();
+        auto placements = search.search(board, tetromino);
+        std::set<state_key_t> found;
+        for (auto p : placements) found.insert({p.column, p.row, p.rotation});
+        isSame &= found.size() == placements.size() && found == referenceSearch(board, tetromino);
+        ++searches;
+        placementsFound += placements.size();
+    }
+    ok &= check(searches > 0 && isSame, "matches the reference search");
+    std::cout << searches << " boards, " << placementsFound / searches
+              << " placements per piece on average\n";
+
+    {
+        // ragged stacks with overhangs below the spawn rows, every tetromino
+        std::uint64_t state = 7;
+        auto nextRandom = [&state] {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            return state >> 33;
+        };
+        bool isSameOnRagged = true;
+        for (int i = 0; i < 200; ++i) {
+            Board board(10, 20);
+            auto top = 4 + nextRandom() % 14;
+            for (std::size_t y = top; y < 20; ++y) {
+                for (std::size_t x = 0; x < 10; ++x) {
+                    if (nextRandom() % 3 == 0) board.set(x, y);
+                }
+            }
+            for (std::size_t type = 0; type < tetrominoes::TYPES_COUNT; ++type) {
+                Tetromino t(static_cast<tetrominoes::TetrominoType>(type));
+                auto placements = search.search(board, t);
+                std::set<state_key_t> found;
+                for (auto p : placements) found.insert({p.column, p.row, p.rotation});
+                isSameOnRagged &= found == referenceSearch(board, t);
+            }
+        }
+        ok &= check(isSameOnRagged, "matches the reference search on ragged stacks");
+    }
+
+    {
+        // a path replayed through the model ends on the placement
+        Game probe(3, 12);
+        auto board = placement_search::lockedBoard(probe.model);
+        auto placements = search.search(board, probe.model.currentTetromino());
+        bool isReplayed = !placements.empty();
+        std::vector<Move> path;
+        for (auto p : placements) {
+            Game game(3, 12);
+            path.clear();
+            search.path(p, path);
+            for (auto move : path) {
+                switch (move) {
+                    case Move::LEFT: isReplayed &= game.model.moveLeftTetromino(); break;
+                    case Move::RIGHT: isReplayed &= game.model.moveRightTetromino(); break;
+                    case Move::ROTATE_RIGHT: isReplayed &= game.model.rotateRightTetromino(); break;
+                    case Move::DOWN: game.model.updateModel(); break;
+                }
+            }
+            const auto& t = game.model.currentTetromino();
+            isReplayed &= t.leftmostPointOnX() == p.column && t.highestPointOnY() == p.row
+                          && t.rotation() == p.rotation
+                          && game.model.piecesLocked() == probe.model.piecesLocked();
+        }
+        ok &= check(isReplayed, "paths lead to their placements");
+    }
+
+    {
+        // the size the game is played at
+        Tetromino t(tetrominoes::TetrominoType::T);
+        for (int i = 0; i < 10; ++i) t.moveRightOneSquare();
+        Board wide(21, 41);
+        constexpr int RUNS = 2000;
+        std::size_t total = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < RUNS; ++i) {
+            total += search.search(wide, t).size();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << total / RUNS << " placements, " << search.statesVisited()
+                  << " states on an empty 21x41 board in "
+                  << std::chrono::duration<double, std::micro>(elapsed).count() / RUNS
+                  << " us\n";
+        ok &= check(total > 0, "search on the full size board");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../include/lock-based-queue.hpp"
+#include "../include/lock-free-queue.hpp"
+
+namespace {
+
+constexpr std::size_t PRODUCERS_COUNT = 4;
+constexpr std::size_t PUSHES_PER_PRODUCER = 200'000;
+
+struct BenchResult {
+    double seconds;
+    std::size_t emptyPops;
+    bool isCorrect;
+};
+
+// every producer pushes its id in the high bits and a counter in the low ones,
+// the consumer checks that each producer's values arrive in order
+template <typename Queue>
+BenchResult runBench(Queue& queue) {
+    std::atomic_bool isStarted = false;
+    std::vector<std::thread> producers;
+    for (std::uint64_t id = 0; id < PRODUCERS_COUNT; ++id) {
+        producers.emplace_back([&, id] {
+            while (!isStarted) std::this_thread::yield();
+            for (std::uint64_t i = 0; i < PUSHES_PER_PRODUCER; ++i) {
+                queue.push((id << 32) | i);
+            }
+        });
+    }
+
+    std::vector<std::uint64_t> expected(PRODUCERS_COUNT, 0);
+    std::size_t emptyPops = 0;
+    bool isCorrect = true;
+
+    auto start = std::chrono::steady_clock::now();
+    isStarted = true;
+    std::uint64_t val;
+    for (std::size_t popped = 0; popped < PRODUCERS_COUNT * PUSHES_PER_PRODUCER;) {
+        // the controller yields on an empty queue too
+        if (!queue.tryPop(val)) {
+            ++emptyPops;
+            std::this_thread::yield();
+            continue;
+        }
+        auto id = val >> 32;
+        if (id >= PRODUCERS_COUNT || (val & 0xffffffff) != expected[id]++) {
+            isCorrect = false;
+        }
+        ++popped;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (auto& t : producers) t.join();
+    return { std::chrono::duration<double>(end - start).count(), emptyPops, isCorrect };
+}
+
+void printResult(const char* name, const BenchResult& res) {
+    auto total = PRODUCERS_COUNT * PUSHES_PER_PRODUCER;
+    std::cout << name << ": " << res.seconds * 1e3 << " ms, "
+              << total / res.seconds / 1e6 << " M events/s, "
+              << res.emptyPops << " empty pops"
+              << (res.isCorrect ? "" : ", LOST OR REORDERED EVENTS") << '\n';
+}
+
+bool testBatchAndWait() {
+    lock_free_queue::LockFreeQueue<int, 8> queue;
+    for (int i = 0; i < 8; ++i) {
+        if (!queue.tryPush(i)) return false;
+    }
+    if (queue.tryPush(8)) return false; // full
+
+    int out[8] = {};
+    if (queue.tryPopBatch(out, 5) != 5 || out[0] != 0 || out[4] != 4) return false;
+    if (queue.tryPopBatch(out, 8) != 3 || out[2] != 7) return false;
+
+    int val = 0;
+    if (queue.waitPopFor(val, std::chrono::milliseconds(1))) return false;
+
+    std::thread producer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        queue.push(42);
+    });
+    queue.waitPop(val);
+    producer.join();
+    return val == 42;
+}
+
+} // namespace
+
+int main() {
+    if (!testBatchAndWait()) {
+        std::cerr << "LockFreeQueue batch/wait test failed\n";
+        return 1;
+    }
+
+    lock_based_queue::LockBasedQueue<std::uint64_t> lockBased;
+    auto lockBasedRes = runBench(lockBased);
+    printResult("LockBasedQueue", lockBasedRes);
+
+    lock_free_queue::LockFreeQueue<std::uint64_t, 1024> lockFree;
+    auto lockFreeRes = runBench(lockFree);
+    printResult("LockFreeQueue ", lockFreeRes);
+
+    return lockBasedRes.isCorrect && lockFreeRes.isCorrect ? 0 : 1;
+}
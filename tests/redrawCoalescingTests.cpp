@@ -0,0 +1,210 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#include "../include/software-render-target.hpp"
+#include "../include/tetris-game-controller.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using namespace std::chrono_literals;
+
+constexpr auto POLL_PERIOD = 10ms;
+
+// presses Down, which like KeyBoardInput asks for three steps, every 
+// interval until it has pressed it presses times, then closes the game
+class ScriptedInput final : public player_input::IPlayerInput {
+public:
+    ScriptedInput(int presses, std::chrono::milliseconds interval) :
+        presses_(presses)
+        , interval_(interval)
+    {}
+
+    void pollInput() override {
+        using observer_n_subject::EventType;
+        auto now = std::chrono::steady_clock::now();
+        if (now < nextPress_) return;
+        nextPress_ = now + interval_;
+        if (presses_-- <= 0) {
+            notify(EventType::USER_ASKED_CLOSE_GAME);
+            return;
+        }
+        notify(EventType::USER_ASKED_DOWN);
+        notify(EventType::USER_ASKED_DOWN);
+        notify(EventType::USER_ASKED_DOWN);
+    }
+
+private:
+    int presses_;
+    std::chrono::milliseconds interval_;
+    std::chrono::steady_clock::time_point nextPress_;
+};
+
+// does nothing until idle has passed, then closes the game
+class IdleInput final : public player_input::IPlayerInput {
+public:
+    explicit IdleInput(std::chrono::milliseconds idle) :
+        idle_(idle)
+    {}
+
+    void pollInput() override {
+        auto now = std::chrono::steady_clock::now();
+        if (closeAt_ == std::chrono::steady_clock::time_point()) closeAt_ = now + idle_;
+        if (now >= closeAt_) notify(observer_n_subject::EventType::USER_ASKED_CLOSE_GAME);
+    }
+
+private:
+    std::chrono::milliseconds idle_;
+    std::chrono::steady_clock::time_point closeAt_;
+};
+
+class CountingTarget final : public render_target::IRenderTarget {
+public:
+    CountingTarget(std::size_t width, std::size_t height) :
+        target_(width, height)
+    {}
+
+    sf::Vector2u size() const override { return target_.size(); }
+    void clear(sf::Color color) override { target_.clear(color); }
+    void fillRect(sf::FloatRect rect, sf::Color color) override { target_.fillRect(rect, color); }
+    void drawTriangles(std::span<const sf::Vertex> vertices, sf::Vector2f offset) override {
+        target_.drawTriangles(vertices, offset);
+    }
+    void drawText(const render_target::TextRun& text) override { target_.drawText(text); }
+    void display() override { ++displays; }
+    std::unique_ptr<render_target::IRenderLayer> createLayer(sf::Vector2u size) override {
+        return target_.createLayer(size);
+    }
+    void drawLayer(render_target::IRenderLayer& layer, sf::Vector2f position) override {
+        target_.drawLayer(layer, position);
+    }
+
+    std::uint64_t displays = 0;
+
+private:
+    render_target::SoftwareRenderTarget target_;
+};
+
+struct Run {
+    tetris_game_controller::FrameStats stats;
+    std::shared_ptr<perf_stats::PerfStats> perf;
+    std::uint64_t displays;
+    std::chrono::steady_clock::duration elapsed;
+    tetris_game_controller::LoopStats loop;
+    // the canvas shows the model's field, painted from dirty rows
+    bool isFieldPainted;
+};
+
+Run play(std::shared_ptr<player_input::IPlayerInput> input, unsigned fps) {
+    auto grid = std::make_shared<view::DrawableGridCanvas>(106.f, 206.f, 21, 41, 1.f);
+    auto text = std::make_shared<view::DrawableText>("Your score:", 8, "");
+    auto stackL = std::make_shared<view::DrawableStackLayout>();
+    stackL->addComponent(grid, "grid");
+    stackL->addComponent(text, "score_text");
+    auto sz = stackL->size();
+
+    auto target = std::make_shared<CountingTarget>(
+        static_cast<std::size_t>(sz.first), static_cast<std::size_t>(sz.second));
+    auto model = std::make_shared<tetris_game_model::TetrisGameModel>();
+    auto controller = std::make_shared<tetris_game_controller::TetrisGameController>(
+        model, input, target, stackL);
+    controller->registerAsObserver();
+    controller->setLoopMode(tetris_game_controller::LoopMode::BLOCKING, POLL_PERIOD);
+    controller->setFrameRateLimit(fps);
+    auto perf = std::make_shared<perf_stats::PerfStats>();
+    controller->setPerfStats(perf);
+
+    std::atomic_bool isGameRun = true;
+    std::atomic_bool isGamePause = false;
+    std::mutex modelMut;
+    model->updateModel();
+    auto start = std::chrono::steady_clock::now();
+    controller->runModel(modelMut, isGameRun, isGamePause);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    auto published = model->snapshotStats();
+    std::cout << published.published << " snapshots published, "
+              << published.totalPublishCost.count() / published.published
+              << " ns each on average\n";
+    bool isFieldPainted = true;
+    const auto& field = model->field();
+    for (std::size_t y = 0; y < field.size(); ++y) {
+        for (std::size_t x = 0; x < field[y].size(); ++x) {
+            isFieldPainted &= grid->cellIndex({x, y}) == static_cast<std::uint8_t>(field[y][x]);
+        }
+    }
+    // the render thread has stopped, nothing else counts frames now
+    return {controller->frameStats(), perf, target->displays, elapsed,
+            controller->loopStats(), isFieldPainted};
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    constexpr int PRESSES = 50;
+    // uncapped: the render thread takes whatever was published when it wakes
+    auto uncapped = play(std::make_shared<ScriptedInput>(PRESSES, 5ms), 0);
+    std::cout << "uncapped: " << uncapped.stats.redrawRequests << " redraw requests, "
+              << uncapped.stats.framesPresented << " frames, "
+              << uncapped.stats.framesCoalesced << " coalesced, "
+              << uncapped.stats.framesDropped << " dropped, "
+              << "latency mean " << uncapped.stats.meanLatency().count() / 1e3 << " us, "
+              << "max " << uncapped.stats.maxLatency.count() / 1e3 << " us\n";
+    ok &= check(uncapped.stats.framesPresented == uncapped.displays, "frames are counted");
+    ok &= check(uncapped.isFieldPainted, "the last frame shows the field");
+    ok &= check(uncapped.stats.framesPresented > 0, "frames are presented");
+    // the model is driven from the loop's thread only, every request is
+    // counted before the render thread stops
+    ok &= check(uncapped.stats.framesPresented + uncapped.stats.framesCoalesced
+                    == uncapped.stats.redrawRequests,
+                "every request is presented or coalesced");
+    // a press asks for three steps at once, drawing one takes longer than
+    // making the next
+    ok &= check(uncapped.stats.framesCoalesced > 0
+                    && uncapped.stats.framesPresented <= 2 * PRESSES + 2,
+                "the steps of a press share frames");
+    ok &= check(uncapped.stats.maxLatency >= uncapped.stats.meanLatency()
+                    && uncapped.stats.meanLatency().count() > 0,
+                "latency is measured");
+    auto input = uncapped.perf->inputLatency.percentiles();
+    std::cout << "input to display p50 " << input.p50 / 1e3 << " us, p99 "
+              << input.p99 / 1e3 << " us over " << input.count << " inputs\n";
+    ok &= check(uncapped.perf->frameTime.percentiles().count > 0
+                    && uncapped.perf->modelUpdate.percentiles().count > 0
+                    && input.count > 0 && input.p50 > 0,
+                "perf stats are sampled");
+
+    // capped: the same input at 20 frames per second
+    auto capped = play(std::make_shared<ScriptedInput>(PRESSES, 5ms), 20);
+    auto seconds = std::chrono::duration<double>(capped.elapsed).count();
+    std::cout << "capped at 20 fps: " << capped.stats.framesPresented << " frames in "
+              << seconds << " s, " << capped.stats.framesDropped << " snapshots dropped\n";
+    ok &= check(capped.stats.framesPresented <= seconds * 20 + 2, "frame cap holds");
+    ok &= check(capped.stats.framesPresented > 0, "capped loop still presents");
+    ok &= check(capped.isFieldPainted, "skipped snapshots are caught up with");
+    ok &= check(capped.stats.framesDropped > 0, "snapshots between frames are skipped");
+    ok &= check(capped.stats.framesPresented + capped.stats.framesCoalesced
+                    == capped.stats.redrawRequests
+                    && capped.stats.framesCoalesced >= capped.stats.framesPresented,
+                "paced frames answer several requests each");
+
+    // idle: nothing to handle, the blocking loop wakes once per poll period
+    constexpr auto IDLE = 500ms;
+    auto idle = play(std::make_shared<IdleInput>(IDLE), 0);
+    auto expectedWakeUps = static_cast<std::uint64_t>(IDLE / POLL_PERIOD);
+    std::cout << "idle for " << IDLE.count() << " ms: " << idle.loop.wakeUps << " wake-ups, "
+              << idle.loop.cpuTime.count() / 1e6 << " ms of loop CPU time\n";
+    ok &= check(idle.loop.wakeUps >= expectedWakeUps / 4
+                    && idle.loop.wakeUps <= expectedWakeUps + expectedWakeUps / 5 + 2,
+                "an idle blocking loop wakes once per poll period");
+    ok &= check(idle.loop.cpuTime < IDLE / 10, "an idle blocking loop barely uses the CPU");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+#include "../include/simulation.hpp"
+#include "../include/tetris-game-model.hpp"
+#include "../include/tetromino.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+simulation::GameResult play(std::uint64_t seed, std::uint64_t maxPieces = 0) {
+    tetris_game_model::TetrisGameModel model(21, 41, seed);
+    simulation::RandomPolicy policy(seed);
+    return simulation::playGame(model, policy, maxPieces);
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    {
+        // every type about equally often, the same sequence for the same seed
+        tetrominoes::TetrominoGenerator gen(42);
+        tetrominoes::TetrominoGenerator same(42);
+        std::array<std::size_t, tetrominoes::TYPES_COUNT> counts {};
+        bool isSame = true;
+        constexpr std::size_t DRAWS = 70'000;
+        for (std::size_t i = 0; i < DRAWS; ++i) {
+            auto type = gen.next().type();
+            isSame &= type == same.next().type();
+            ++counts[static_cast<std::size_t>(type)];
+        }
+        ok &= check(isSame, "a seed gives one sequence");
+        bool isUniform = true;
+        for (auto c : counts) {
+            isUniform &= c > DRAWS / tetrominoes::TYPES_COUNT * 9 / 10
+                         && c < DRAWS / tetrominoes::TYPES_COUNT * 11 / 10;
+        }
+        ok &= check(isUniform, "types are uniform");
+    }
+
+    auto a = play(7);
+    auto b = play(7);
+    std::cout << "seed 7: " << a.pieces << " pieces, " << a.lines << " lines, score "
+              << a.score << '\n';
+    ok &= check(a.isFinished, "the game ends");
+    ok &= check(a.pieces == b.pieces && a.lines == b.lines && a.score == b.score,
+                "a seed replays the same game");
+    // every line takes 21 blocks of 4 per piece
+    ok &= check(a.pieces > 0 && a.lines * 21 <= a.pieces * 4, "counters add up");
+
+    auto capped = play(7, 5);
+    ok &= check(capped.pieces == 5 && !capped.isFinished, "piece limit");
+
+    {
+        tetris_game_model::TetrisGameModel model(21, 41, 1);
+        simulation::DropPolicy policy;
+        auto res = simulation::playGame(model, policy);
+        // the spawn columns fill up long before the field does
+        ok &= check(res.isFinished && res.lines == 0 && res.pieces < 41, "drop policy");
+    }
+
+    {
+        // no reader, nothing published until one asks
+        tetris_game_model::TetrisGameModel model(10, 20, 3);
+        simulation::RandomPolicy policy(3);
+        simulation::playGame(model, policy, 20);
+        bool isQuiet = model.snapshotStats().published == 0
+            && model.latestSnapshot().sequence == 0;
+        model.setSnapshotPublishing(true);
+        const auto& snapshot = model.latestSnapshot();
+        bool isCurrent = snapshot.sequence == 1 && snapshot.cells.size() == 10 * 20;
+        for (std::size_t y = 0; y < 20; ++y) {
+            for (std::size_t x = 0; x < 10; ++x) {
+                isCurrent &= snapshot.at(x, y) == model.field()[y][x];
+            }
+        }
+        ok &= check(isQuiet && isCurrent, "snapshots are published on demand");
+    }
+
+    return ok ? 0 : 1;
+}
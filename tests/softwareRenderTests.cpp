@@ -0,0 +1,114 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+
+#include "../include/software-render-target.hpp"
+#include "../include/view.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+// update when the rasteriser or the view tree below changes on purpose,
+// after checking the image written by `render_tst out.ppm`
+constexpr std::uint64_t GOLDEN_HASH = 0x71c473186554eed8ull;
+
+std::uint64_t fnv1a(std::span<const std::uint8_t> bytes) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (auto b : bytes) {
+        hash = (hash ^ b) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const sf::Color frameColor(60, 60, 60);
+
+    auto grid = std::make_shared<view::DrawableGridCanvas>(
+        111.f, 221.f, 10, 20, 1.f);
+    grid->paintCell({0, 0}, sf::Color::Red);
+    grid->paintCell({9, 19}, sf::Color::Blue);
+    grid->paintCell({4, 10}, sf::Color(0, 255, 0, 128));
+
+    auto frame = std::make_shared<view::DrawableFrame>(
+        131.f, 241.f, 5.f, frameColor);
+    auto frameLayer = std::make_shared<view::DrawableRetainedLayer>();
+    frameLayer->addComponent(frame, "frame");
+
+    auto nestedL = std::make_shared<view::DrawableNestedLayout>(10.f, 10.f);
+    nestedL->addComponent(frameLayer, "frame_layer");
+    nestedL->addComponent(grid, "grid");
+
+    auto text = std::make_shared<view::DrawableText>(
+        "Score: 1234", 16, "", sf::Color::Black, sf::Vector2f(4.f, 0.f));
+
+    auto stackL = std::make_shared<view::DrawableStackLayout>();
+    stackL->addComponent(nestedL, "nestedL");
+    stackL->addComponent(text, "score_text");
+
+    auto sz = stackL->size();
+    render_target::SoftwareRenderTarget target(
+        static_cast<std::size_t>(sz.first), static_cast<std::size_t>(sz.second));
+    target.clear(sf::Color::White);
+    stackL->draw(target, {0.f, 0.f});
+
+    if (argc > 1 && !target.saveToPpm(argv[1])) {
+        std::cerr << "cannot write " << argv[1] << '\n';
+    }
+
+    bool ok = true;
+    // text is on top, the board starts below it
+    float top = text->size().second;
+    auto at = [&](float x, float y) {
+        return target.pixel(static_cast<std::size_t>(x), static_cast<std::size_t>(top + y));
+    };
+    ok &= check(at(2.f, 2.f) == frameColor, "frame border");
+    ok &= check(at(7.f, 7.f) == sf::Color::White, "frame inside");
+    ok &= check(at(10.5f, 20.f) == sf::Color::Black, "grid line");
+    ok &= check(at(16.f, 16.f) == sf::Color::Red, "painted cell");
+    ok &= check(at(10.f + 9 * 11 + 6, 10.f + 19 * 11 + 6) == sf::Color::Blue, "last cell");
+    ok &= check(at(10.f + 4 * 11 + 6, 10.f + 10 * 11 + 6) == sf::Color(127, 255, 127),
+                "translucent cell is blended");
+    ok &= check(at(10.f + 2 * 11 + 6, 10.f + 2 * 11 + 6) == sf::Color::White, "empty cell");
+    // first row of the "S" after the 4 px offset
+    ok &= check(target.pixel(6, 0) == sf::Color::Black, "text ink");
+
+    auto hash = fnv1a(target.pixels());
+    ok &= check(hash == GOLDEN_HASH, "golden image");
+
+    // frame build time with one cell changing per frame, as during play
+    constexpr int FRAMES = 200;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FRAMES; ++i) {
+        grid->paintCell({static_cast<std::size_t>(i % 10), 5},
+                        i % 2 ? sf::Color::Cyan : sf::Color::Magenta);
+        target.clear(sf::Color::White);
+        stackL->draw(target, {0.f, 0.f});
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "hash " << std::hex << hash << std::dec << ", "
+              << std::chrono::duration<double, std::micro>(elapsed).count() / FRAMES
+              << " us per " << target.size().x << 'x' << target.size().y << " frame, "
+              << "frame layer rendered " << frameLayer->renderCount() << " time(s)\n";
+    ok &= check(frameLayer->renderCount() == 1, "static layer rendered once");
+    ok &= check(grid->palette().size() == 6, "repainting reuses palette entries");
+
+    // a whole row of palette indices at once, as the controller paints the board
+    std::array<std::uint8_t, 10> row {};
+    row[3] = grid->cellIndex({0, 0});
+    row[8] = grid->cellIndex({9, 19});
+    grid->paintRow(7, row);
+    target.clear(sf::Color::White);
+    stackL->draw(target, {0.f, 0.f});
+    ok &= check(at(10.f + 3 * 11 + 6, 10.f + 7 * 11 + 6) == sf::Color::Red
+                    && at(10.f + 8 * 11 + 6, 10.f + 7 * 11 + 6) == sf::Color::Blue
+                    && at(10.f + 4 * 11 + 6, 10.f + 7 * 11 + 6) == sf::Color::White,
+                "row painted from indices");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/terminal-render-target.hpp"
+#include "../include/view.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+// understands exactly the sequences TerminalRenderTarget writes
+class VirtualScreen {
+public:
+    struct Cell {
+        std::string glyph = " ";
+        sf::Color fg;
+        sf::Color bg;
+    };
+
+    VirtualScreen(std::size_t columns, std::size_t rows) :
+        columns_(columns)
+        , rows_(rows)
+        , cells_(columns * rows)
+    {}
+
+    // false on anything unexpected
+    bool feed(const std::string& bytes) {
+        std::size_t i = 0;
+        while (i < bytes.size()) {
+            char ch = bytes[i];
+            if (ch == '\x1b') {
+                if (bytes.compare(i, 2, "\x1b[") != 0) return false;
+                auto end = bytes.find_first_of("HCmJlh", i + 2);
+                if (end == std::string::npos) return false;
+                if (!control_(bytes.substr(i + 2, end - i - 2), bytes[end])) return false;
+                i = end + 1;
+            } else if (ch == '\r') {
+                col_ = 0;
+                ++i;
+            } else if (ch == '\n') {
+                ++row_;
+                ++i;
+            } else if (static_cast<unsigned char>(ch) == 0xe2) {
+                if (!put_(bytes.substr(i, 3))) return false;
+                i += 3;
+            } else {
+                if (!put_(std::string(1, ch))) return false;
+                ++i;
+            }
+        }
+        return true;
+    }
+
+    const Cell& at(std::size_t col, std::size_t row) const {
+        return cells_[row * columns_ + col];
+    }
+
+private:
+    bool control_(const std::string& params, char op) {
+        std::vector<int> args;
+        std::stringstream ss(params);
+        std::string part;
+        while (std::getline(ss, part, ';')) {
+            if (part == "?25") return true;
+            args.push_back(part.empty() ? 0 : std::stoi(part));
+        }
+        switch (op) {
+            case 'H':
+                row_ = args.at(0) - 1;
+                col_ = args.at(1) - 1;
+                return true;
+            case 'C':
+                col_ += args.at(0);
+                return true;
+            case 'J':
+                return true;
+            case 'm':
+                for (std::size_t k = 0; k < args.size(); ++k) {
+                    if (args[k] == 0) continue;
+                    if ((args[k] != 38 && args[k] != 48) || args.at(k + 1) != 2) return false;
+                    sf::Color c(args.at(k + 2), args.at(k + 3), args.at(k + 4));
+                    (args[k] == 38 ? fg_ : bg_) = c;
+                    k += 4;
+                }
+                return true;
+        }
+        return false;
+    }
+
+    bool put_(std::string glyph) {
+        if (row_ >= rows_ || col_ >= columns_) return false;
+        cells_[row_ * columns_ + col_] = {std::move(glyph), fg_, bg_};
+        ++col_;
+        return true;
+    }
+
+    std::size_t columns_;
+    std::size_t rows_;
+    std::vector<Cell> cells_;
+    std::size_t row_ = 0;
+    std::size_t col_ = 0;
+    sf::Color fg_;
+    sf::Color bg_;
+};
+
+// the colours a cell shows, whatever way it was written
+bool shows(const VirtualScreen::Cell& cell, sf::Color top, sf::Color bottom) {
+    if (cell.glyph == " ") return top == bottom && cell.bg == bottom;
+    return cell.glyph == "\xe2\x96\x80" && cell.fg == top && cell.bg == bottom;
+}
+
+} // namespace
+
+int main() {
+    // one pixel per dot, as main() sets it up
+    const sf::Vector2f cellSize(1.f, 2.f);
+
+    auto grid = std::make_shared<view::DrawableGridCanvas>(20.f, 20.f, 10, 10, 0.f);
+    auto frame = std::make_shared<view::DrawableFrame>(
+        22.f, 22.f, 1.f, sf::Color(60, 60, 60));
+    auto frameLayer = std::make_shared<view::DrawableRetainedLayer>();
+    frameLayer->addComponent(frame, "frame");
+    auto nestedL = std::make_shared<view::DrawableNestedLayout>(1.f, 1.f);
+    nestedL->addComponent(frameLayer, "frame_layer");
+    nestedL->addComponent(grid, "grid");
+    auto text = std::make_shared<view::DrawableText>(
+        "Score: 0", 2, "", sf::Color::Black, sf::Vector2f(1.f, 0.f));
+    auto stackL = std::make_shared<view::DrawableStackLayout>();
+    stackL->addComponent(nestedL, "nestedL");
+    stackL->addComponent(text, "score_text");
+
+    auto sz = stackL->size();
+    std::size_t columns = static_cast<std::size_t>(std::ceil(sz.first / cellSize.x));
+    std::size_t rows = static_cast<std::size_t>(std::ceil(sz.second / cellSize.y));
+
+    std::ostringstream out;
+    VirtualScreen screen(columns, rows);
+    bool ok = true;
+    {
+        render_target::TerminalRenderTarget target(columns, rows, cellSize, out);
+        auto frameOut = [&] {
+            out.str("");
+            target.clear(sf::Color::White);
+            stackL->draw(target, {0.f, 0.f});
+            target.display();
+            ok &= check(screen.feed(out.str()), "output parses");
+            return target.lastFrameBytes();
+        };
+
+        auto first = frameOut();
+        ok &= check(target.lastFrameCells() == columns * rows, "first frame paints everything");
+        std::cout << columns << 'x' << rows << " cells, first frame " << first << " bytes\n";
+
+        ok &= check(frameOut() == 0, "unchanged frame writes nothing");
+
+        // the board starts below the text, one dot of frame then the cells
+        float top = text->size().second;
+        grid->paintCell({0, 0}, sf::Color::Red);
+        auto oneCell = frameOut();
+        std::cout << "one grid cell changed: " << oneCell << " bytes, "
+                  << target.lastFrameCells() << " terminal cell(s)\n";
+        // 2x2 dots touch at most 2x2 terminal cells, each needs its colours set
+        ok &= check(target.lastFrameCells() <= 4, "only the touched cells are written");
+        ok &= check(oneCell > 0 && oneCell < 100, "one cell costs a few bytes");
+
+        // first dot whose centre is on the cell
+        std::size_t dotRow = static_cast<std::size_t>(std::ceil(top + 1.f - 0.5f));
+        const auto& cell = screen.at(2, dotRow / 2);
+        ok &= check(dotRow % 2 == 0
+                        ? shows(cell, sf::Color::Red, sf::Color::Red)
+                        : shows(cell, sf::Color(60, 60, 60), sf::Color::Red)
+                          || shows(cell, sf::Color::White, sf::Color::Red),
+                    "painted cell shows red");
+
+        // a falling piece: four cells move one row down
+        for (std::size_t x = 3; x < 7; ++x) grid->paintCell({x, 4}, sf::Color::Cyan);
+        frameOut();
+        for (std::size_t x = 3; x < 7; ++x) {
+            grid->paintCell({x, 4}, sf::Color::White);
+            grid->paintCell({x, 5}, sf::Color::Cyan);
+        }
+        auto move = frameOut();
+        std::cout << "piece moved one row: " << move << " bytes\n";
+        ok &= check(move < 200, "a move costs a few bytes");
+
+        text->setText("Score: 100");
+        frameOut();
+        ok &= check(screen.at(1, 0).glyph == "S" && screen.at(10, 0).glyph == "0",
+                    "text is written as characters");
+
+        // the screen rebuilt from diffs equals a full repaint
+        std::ostringstream fullOut;
+        VirtualScreen fullScreen(columns, rows);
+        render_target::TerminalRenderTarget full(columns, rows, cellSize, fullOut);
+        full.clear(sf::Color::White);
+        stackL->draw(full, {0.f, 0.f});
+        full.display();
+        ok &= check(fullScreen.feed(fullOut.str()), "full output parses");
+        bool isSame = true;
+        for (std::size_t r = 0; r < rows; ++r) {
+            for (std::size_t c = 0; c < columns; ++c) {
+                const auto& a = screen.at(c, r);
+                const auto& b = fullScreen.at(c, r);
+                bool same = a.glyph == b.glyph && a.bg == b.bg
+                            && (a.glyph == " " || a.fg == b.fg);
+                isSame &= same;
+            }
+        }
+        ok &= check(isSame, "diffs add up to the full frame");
+    }
+
+    return ok ? 0 : 1;
+}
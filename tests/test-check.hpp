@@ -0,0 +1,16 @@
+#ifndef TEST_CHECK_HPP
+#define TEST_CHECK_HPP
+
+#include <iostream>
+
+namespace test_check {
+
+// reports a failed check, returns cond so a test can keep going
+inline bool check(bool cond, const char* what) {
+    if (!cond) std::cerr << "FAILED: " << what << '\n';
+    return cond;
+}
+
+} // namespace test_check
+
+#endif // TEST_CHECK_HPP
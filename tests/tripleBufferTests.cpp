@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+#include "../include/triple-buffer.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+// a snapshot is torn if its words disagree
+struct Payload {
+    std::uint64_t sequence = 0;
+    std::array<std::uint64_t, 107> words {};
+    std::chrono::steady_clock::time_point publishedAt;
+};
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    {
+        triple_buffer::TripleBuffer<int> buf(7);
+        ok &= check(!buf.acquire() && buf.front() == 7, "nothing published yet");
+        buf.back() = 1;
+        buf.publish();
+        buf.back() = 2;
+        buf.publish();
+        ok &= check(buf.acquire() && buf.front() == 2, "reader gets the newest value");
+        ok &= check(!buf.acquire() && buf.front() == 2, "and keeps it until a newer one");
+        buf.back() = 3;
+        buf.publish();
+        ok &= check(buf.acquire() && buf.front() == 3, "writer reuses the buffers");
+    }
+
+    constexpr std::uint64_t PUBLISHES = 200'000;
+    triple_buffer::TripleBuffer<Payload> buf;
+    std::atomic_bool isDone = false;
+    std::chrono::nanoseconds writerWorst {0};
+
+    std::thread writer([&] {
+        for (std::uint64_t seq = 1; seq <= PUBLISHES; ++seq) {
+            auto start = std::chrono::steady_clock::now();
+            auto& p = buf.back();
+            p.sequence = seq;
+            p.words.fill(seq);
+            p.publishedAt = std::chrono::steady_clock::now();
+            buf.publish();
+            writerWorst = std::max<std::chrono::nanoseconds>(
+                writerWorst, std::chrono::steady_clock::now() - start);
+        }
+        isDone = true;
+    });
+
+    std::uint64_t reads = 0;
+    std::uint64_t last = 0;
+    bool isTorn = false;
+    bool isBackwards = false;
+    std::chrono::nanoseconds maxAge {0};
+    auto readOnce = [&] {
+        if (!buf.acquire()) return;
+        const auto& p = buf.front();
+        maxAge = std::max<std::chrono::nanoseconds>(
+            maxAge, std::chrono::steady_clock::now() - p.publishedAt);
+        isTorn |= std::any_of(p.words.begin(), p.words.end(),
+                              [&](auto w) { return w != p.sequence; });
+        isBackwards |= p.sequence <= last;
+        last = p.sequence;
+        ++reads;
+    };
+    while (!isDone) {
+        readOnce();
+    }
+    writer.join();
+    readOnce();
+
+    std::cout << reads << " of " << PUBLISHES << " snapshots read, "
+              << "worst writer publish " << writerWorst.count() << " ns, "
+              << "oldest snapshot read " << maxAge.count() / 1e3 << " us\n";
+    ok &= check(!isTorn, "no torn snapshot");
+    ok &= check(!isBackwards, "sequence only grows");
+    ok &= check(last == PUBLISHES, "the last snapshot arrives");
+
+    return ok ? 0 : 1;
+}
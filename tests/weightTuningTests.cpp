@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "../include/lookahead-bot.hpp"
+#include "../include/task-pool.hpp"
+#include "../include/weight-tuning.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using lookahead_bot::Weights;
+
+// short games one tetromino deep
+weight_tuning::TuningOptions smallOptions() {
+    weight_tuning::TuningOptions options;
+    options.population = 8;
+    options.elites = 3;
+    options.gamesPerCandidate = 2;
+    options.seed = 9;
+    options.setup = {10, 20, 40, {1, 1, 0}};
+    return options;
+}
+
+// every row of a few generations
+std::string tune(task_pool::TaskPool& pool, std::size_t generations, const Weights& initial,
+                 double& lastBest) {
+    weight_tuning::CrossEntropyTuner tuner(pool, smallOptions(), initial);
+    std::ostringstream csv;
+    weight_tuning::writeCsvHeader(csv);
+    for (std::size_t g = 0; g < generations; ++g) {
+        auto candidates = tuner.step();
+        for (const auto& candidate : candidates) weight_tuning::writeCsvRow(csv, candidate);
+        lastBest = candidates.front().fitness.meanScore;
+    }
+    return csv.str();
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+    task_pool::TaskPool single(1);
+    task_pool::TaskPool pool(4);
+
+    {
+        Weights weights {1, 2, 3, 4, 5, 6, 7};
+        auto vector = weight_tuning::toVector(weights);
+        auto back = weight_tuning::toVector(weight_tuning::fromVector(vector));
+        ok &= check(vector == weight_tuning::weight_vector_t{1, 2, 3, 4, 5, 6, 7} && back == vector,
+                    "weights to a vector and back");
+    }
+
+    {
+        weight_tuning::GameSetup setup {10, 20, 40, {2, 4, 1 << 12}};
+        auto res = weight_tuning::playGame(pool, {}, setup, 5);
+        auto same = weight_tuning::playGame(single, {}, setup, 5);
+        ok &= check(res.pieces == 40 && res.score == same.score && res.lines == same.lines,
+                    "a game depends on the weights and the seed only");
+    }
+
+    {
+        // rewards holes and height, the tuner has to turn it around
+        Weights bad {0.5, 0.0, 0.5, 0.0};
+        double badBest = 0.0;
+        double tunedBest = 0.0;
+        auto first = tune(pool, 1, bad, badBest);
+        auto rows = tune(pool, 4, bad, tunedBest);
+        double singleBest = 0.0;
+        auto singleRows = tune(single, 4, bad, singleBest);
+        ok &= check(rows == singleRows, "the same rows whatever the threads");
+        ok &= check(rows.starts_with(first), "a run repeats its first generation");
+        ok &= check(tunedBest > badBest, "the tuner improves on bad weights");
+
+        auto lines = std::count(rows.begin(), rows.end(), '\n');
+        std::istringstream in(rows);
+        std::string header;
+        std::string row;
+        std::getline(in, header);
+        std::getline(in, row);
+        ok &= check(lines == 1 + 4 * 8
+                    && std::count(header.begin(), header.end(), ',') == 12
+                    && std::count(row.begin(), row.end(), ',') == 12,
+                    "a CSV row per candidate");
+        std::cout << "best mean score " << badBest << " -> " << tunedBest << " in 4 generations\n";
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../include/lookahead-bot.hpp"
+#include "../include/placement-search.hpp"
+#include "../include/simulation.hpp"
+#include "../include/task-pool.hpp"
+#include "../include/tetris-game-model.hpp"
+#include "../include/transposition-table.hpp"
+#include "../include/zobrist.hpp"
+#include "test-check.hpp"
+
+namespace {
+
+using test_check::check;
+
+using placement_search::Board;
+using tetris_game_model::BlockType;
+using tetris_game_model::TetrisGameModel;
+
+// from scratch, block by block
+std::uint64_t boardHash(const Board& board) {
+    std::uint64_t hash = 0;
+    for (std::size_t y = 0; y < board.height(); ++y) {
+        for (std::size_t x = 0; x < board.width(); ++x) {
+            if (board.test(x, y)) hash ^= zobrist::blockKey(x, y);
+        }
+    }
+    return hash;
+}
+
+// the locked blocks of the field, the falling tetromino left out
+std::uint64_t fieldHash(const TetrisGameModel& model) {
+    std::uint64_t hash = 0;
+    const auto& field = model.field();
+    const auto& tetromino = model.currentTetromino();
+    for (std::size_t y = 0; y < field.size(); ++y) {
+        for (std::size_t x = 0; x < field[y].size(); ++x) {
+            auto block = field[y][x];
+            if (block == BlockType::VOID || block == BlockType::GHOST) continue;
+            if (!model.isGameFinished() && tetromino.containsBlock(
+                    {static_cast<int>(x), static_cast<int>(y)})) continue;
+            hash ^= zobrist::blockKey(x, y);
+        }
+    }
+    return hash;
+}
+
+// checks the model's hash after every tetromino, returns the lines cleared
+std::uint64_t checkGame(TetrisGameModel& model, simulation::Policy& policy,
+                        std::uint64_t pieces, bool& isSame) {
+    for (std::uint64_t i = 0; i < pieces && !model.isGameFinished(); ++i) {
+        policy.placeTetromino(model);
+        model.hardDropTetromino();
+        isSame &= model.lockedFieldHash() == fieldHash(model);
+        if (model.fieldWidth() <= Board::MAX_WIDTH) {
+            isSame &= model.lockedFieldHash() == placement_search::lockedBoard(model).hash();
+        }
+    }
+    return model.linesCleared();
+}
+
+struct BotRun {
+    simulation::GameResult result;
+    std::uint64_t nodes = 0;
+    std::uint64_t hits = 0;
+};
+
+BotRun playBot(task_pool::TaskPool& pool, std::uint64_t pieces,
+               lookahead_bot::SearchOptions options) {
+    TetrisGameModel model(10, 20, 11);
+    lookahead_bot::LookaheadSearch search(pool, {}, options);
+    placement_search::PlacementSearch placementSearch;
+    std::vector<placement_search::Move> path;
+    BotRun run;
+    // LookaheadPolicy without hiding its search
+    for (; run.result.pieces < pieces && !model.isGameFinished(); ++run.result.pieces) {
+        auto board = placement_search::lockedBoard(model);
+        const auto& tetromino = model.currentTetromino();
+        auto decision = search.decide(board, tetromino);
+        path.clear();
+        for (const auto& placement : placementSearch.search(board, tetromino)) {
+            if (placement_search::isSamePlacement(placement, decision.placement)) {
+                placementSearch.path(placement, path);
+                break;
+            }
+        }
+        for (auto move : path) {
+            switch (move) {
+                case placement_search::Move::LEFT: model.moveLeftTetromino(); break;
+                case placement_search::Move::RIGHT: model.moveRightTetromino(); break;
+                case placement_search::Move::ROTATE_RIGHT: model.rotateRightTetromino(); break;
+                case placement_search::Move::DOWN: model.updateModel(); break;
+            }
+        }
+        model.hardDropTetromino();
+    }
+    run.result.lines = model.linesCleared();
+    run.result.score = model.score();
+    run.nodes = search.nodesSearched();
+    run.hits = search.tableHits();
+    return run;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    {
+        Board board(6, 8);
+        board.set(2, 3);
+        board.set(2, 3);
+        board.set(5, 7);
+        auto hash = board.hash();
+        board.set(0, 0);
+        board.reset(0, 0);
+        board.reset(0, 0);
+        ok &= check(hash == boardHash(board) && hash == (zobrist::blockKey(2, 3)
+                    ^ zobrist::blockKey(5, 7)), "set and reset keep the hash");
+        ok &= check(Board(6, 8).hash() == 0, "an empty board hashes to 0");
+    }
+
+    {
+        // random placements locked one after another, lines deleted on the way
+        std::mt19937_64 gen(7);
+        placement_search::PlacementSearch search;
+        bool isSame = true;
+        std::size_t lines = 0;
+        for (int game = 0; game < 20; ++game) {
+            Board board(8, 16);
+            for (int i = 0; i < 200; ++i) {
+                auto type = static_cast<tetrominoes::TetrominoType>(gen() % tetrominoes::TYPES_COUNT);
+                auto placements = search.search(board, lookahead_bot::spawnedTetromino(type, 8));
+                if (placements.empty()) break;
+                // low ones, so lines fill up
+                auto placement = placements.front();
+                for (const auto& other : placements) {
+                    if (other.row + static_cast<int>(gen() % 3) > placement.row) placement = other;
+                }
+                lines += board.lock(type, placement);
+                isSame &= board.hash() == boardHash(board);
+            }
+        }
+        ok &= check(isSame && lines > 30, "lock keeps the hash");
+    }
+
+    {
+        bool isSame = true;
+        task_pool::TaskPool pool(1);
+        TetrisGameModel bitboard(10, 20, 3);
+        lookahead_bot::LookaheadPolicy bot(pool, {}, {1, 1, 0});
+        auto lines = checkGame(bitboard, bot, 300, isSame);
+        TetrisGameModel ghost(Board::MAX_WIDTH + 8, 30, 3);
+        simulation::RandomPolicy random(3);
+        checkGame(ghost, random, 300, isSame);
+        ok &= check(isSame && lines > 50,
+                    "the model's hash follows locks and deleted lines");
+    }
+
+    {
+        transposition_table::TranspositionTable table(1000);
+        bool isRight = table.size() == 1024 && !table.probe(42);
+        table.store(42, 1.5);
+        isRight &= table.probe(42) == 1.5 && !table.probe(42 + 1024);
+        // the same slot, the last store wins
+        table.store(42 + 1024, -2.0);
+        isRight &= !table.probe(42) && table.probe(42 + 1024) == -2.0;
+        table.clear();
+        isRight &= !table.probe(42 + 1024);
+        ok &= check(isRight, "probe and store");
+    }
+
+    {
+        // a few slots fought over, a hit must never be another key's value
+        transposition_table::TranspositionTable table(16);
+        std::atomic<bool> isWrong = false;
+        std::atomic<std::uint64_t> hits = 0;
+        std::vector<std::thread> threads;
+        for (std::uint64_t t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t] {
+                std::mt19937_64 gen(t);
+                std::uint64_t found = 0;
+                for (int i = 0; i < 200000; ++i) {
+                    auto key = zobrist::mix(gen() % 64);
+                    if (auto value = table.probe(key)) {
+                        ++found;
+                        if (*value != static_cast<double>(key >> 11)) isWrong = true;
+                    } else {
+                        table.store(key, static_cast<double>(key >> 11));
+                    }
+                }
+                hits += found;
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        ok &= check(!isWrong && hits > 0, "racing stores never give a wrong value");
+    }
+
+    {
+        // the same games with the table and without it, on one thread and on four
+        constexpr std::uint64_t PIECES = 20;
+        constexpr lookahead_bot::SearchOptions CACHED {3, 4};
+        constexpr lookahead_bot::SearchOptions UNCACHED {3, 4, 0};
+        task_pool::TaskPool single(1);
+        task_pool::TaskPool pool(4);
+        auto start = std::chrono::steady_clock::now();
+        auto cached = playBot(single, PIECES, CACHED);
+        auto cachedTime = std::chrono::steady_clock::now() - start;
+        start = std::chrono::steady_clock::now();
+        auto uncached = playBot(single, PIECES, UNCACHED);
+        auto uncachedTime = std::chrono::steady_clock::now() - start;
+        auto parallel = playBot(pool, PIECES, CACHED);
+        ok &= check(cached.result.lines == uncached.result.lines
+                    && cached.result.score == uncached.result.score
+                    && parallel.result.score == cached.result.score
+                    && cached.result.pieces == PIECES, "the table does not change the game");
+        ok &= check(uncached.hits == 0 && cached.hits > 0 && cached.nodes < uncached.nodes,
+                    "the table saves placement searches");
+        std::cout << "depth " << CACHED.depth << ", beam " << CACHED.beamWidth << ": "
+                  << uncached.nodes << " -> " << cached.nodes << " nodes ("
+                  << cached.hits << " table hits), "
+                  << std::chrono::duration<double, std::milli>(uncachedTime).count() << " -> "
+                  << std::chrono::duration<double, std::milli>(cachedTime).count() << " ms\n";
+    }
+
+    return ok ? 0 : 1;
+}
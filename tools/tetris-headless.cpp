@@ -0,0 +1,112 @@
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string_view>
+
+#include "../include/lookahead-bot.hpp"
+#include "../include/placement-search.hpp"
+#include "../include/simulation.hpp"
+#include "../include/task-pool.hpp"
+#include "../include/tetris-game-model.hpp"
+
+namespace {
+
+struct Options {
+    std::uint64_t games = 100;
+    std::uint64_t seed = 1;
+    std::uint64_t maxPieces = 0;
+    std::size_t width = 21;
+    std::size_t height = 41;
+    std::string_view policy = "random";
+};
+
+void printUsage() {
+    std::cerr << "usage: tetris_headless [--games N] [--seed S] [--max-pieces N]\n"
+                 "                       [--width W] [--height H]\n"
+                 "                       [--policy drop|random|lookahead]\n"
+                 "lookahead rarely loses, it needs --max-pieces;\n"
+                 "it searches fields up to "
+              << placement_search::Board::MAX_WIDTH << " wide\n";
+}
+
+template <typename T>
+bool parseNumber(std::string_view str, T& out) {
+    auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), out);
+    return ec == std::errc() && end == str.data() + str.size();
+}
+
+bool parseOptions(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (i + 1 >= argc) return false;
+        std::string_view value = argv[++i];
+        bool ok = true;
+        if (arg == "--games") {
+            ok = parseNumber(value, opts.games);
+        } else if (arg == "--seed") {
+            ok = parseNumber(value, opts.seed);
+        } else if (arg == "--max-pieces") {
+            ok = parseNumber(value, opts.maxPieces);
+        } else if (arg == "--width") {
+            ok = parseNumber(value, opts.width) && opts.width >= 4;
+        } else if (arg == "--height") {
+            ok = parseNumber(value, opts.height) && opts.height >= 4;
+        } else if (arg == "--policy") {
+            opts.policy = value;
+            ok = value == "drop" || value == "random" || value == "lookahead";
+        } else {
+            ok = false;
+        }
+        if (!ok) return false;
+    }
+    // the lookahead searches a bitboard no wider than MAX_WIDTH
+    return opts.policy != "lookahead"
+        || (opts.maxPieces != 0 && opts.width <= placement_search::Board::MAX_WIDTH);
+}
+
+std::unique_ptr<simulation::Policy> makePolicy(
+    std::string_view name, std::uint64_t seed, task_pool::TaskPool& pool) {
+    if (name == "drop") {
+        return std::make_unique<simulation::DropPolicy>();
+    }
+    if (name == "lookahead") {
+        return std::make_unique<lookahead_bot::LookaheadPolicy>(pool);
+    }
+    return std::make_unique<simulation::RandomPolicy>(seed);
+}
+
+} // namespace
+
+// plays games back to back on one thread as fast as the model allows,
+// game i uses seed + i for its tetrominoes and its policy
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseOptions(argc, argv, opts)) {
+        printUsage();
+        return 1;
+    }
+
+    task_pool::TaskPool pool;
+    std::uint64_t pieces = 0;
+    std::uint64_t lines = 0;
+    std::int64_t score = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t game = 0; game < opts.games; ++game) {
+        tetris_game_model::TetrisGameModel model(opts.width, opts.height, opts.seed + game);
+        auto policy = makePolicy(opts.policy, opts.seed + game, pool);
+        auto res = simulation::playGame(model, *policy, opts.maxPieces);
+        pieces += res.pieces;
+        lines += res.lines;
+        score += res.score;
+    }
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << opts.games << " games, " << pieces << " pieces, " << lines << " lines, "
+              << "score " << score << " in " << seconds << " s\n"
+              << opts.games / seconds << " games/s, "
+              << pieces / seconds << " pieces/s, "
+              << lines / seconds << " lines/s\n";
+    return 0;
+}
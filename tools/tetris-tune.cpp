@@ -0,0 +1,122 @@
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "../include/lookahead-bot.hpp"
+#include "../include/task-pool.hpp"
+#include "../include/weight-tuning.hpp"
+
+namespace {
+
+struct Options {
+    std::size_t generations = 20;
+    std::size_t threads = std::thread::hardware_concurrency();
+    std::string_view csv;
+    weight_tuning::TuningOptions tuning;
+};
+
+void printUsage() {
+    std::cerr << "usage: tetris_tune [--generations N] [--population N] [--elites N]\n"
+                 "                   [--games N] [--max-pieces N] [--seed S]\n"
+                 "                   [--width W] [--height H] [--depth D] [--beam B]\n"
+                 "                   [--threads N] [--csv FILE]\n"
+                 "a row per candidate goes to FILE, or to stdout without one\n";
+}
+
+template <typename T>
+bool parseNumber(std::string_view str, T& out) {
+    auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), out);
+    return ec == std::errc() && end == str.data() + str.size();
+}
+
+bool parseOptions(int argc, char** argv, Options& opts) {
+    auto& tuning = opts.tuning;
+    auto& setup = tuning.setup;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (i + 1 >= argc) return false;
+        std::string_view value = argv[++i];
+        bool ok = true;
+        if (arg == "--generations") {
+            ok = parseNumber(value, opts.generations);
+        } else if (arg == "--population") {
+            ok = parseNumber(value, tuning.population) && tuning.population > 0;
+        } else if (arg == "--elites") {
+            ok = parseNumber(value, tuning.elites) && tuning.elites > 0;
+        } else if (arg == "--games") {
+            ok = parseNumber(value, tuning.gamesPerCandidate) && tuning.gamesPerCandidate > 0;
+        } else if (arg == "--max-pieces") {
+            ok = parseNumber(value, setup.maxPieces);
+        } else if (arg == "--seed") {
+            ok = parseNumber(value, tuning.seed);
+        } else if (arg == "--width") {
+            ok = parseNumber(value, setup.width) && setup.width >= 4
+                && setup.width <= placement_search::Board::MAX_WIDTH;
+        } else if (arg == "--height") {
+            ok = parseNumber(value, setup.height) && setup.height >= 4;
+        } else if (arg == "--depth") {
+            ok = parseNumber(value, setup.search.depth) && setup.search.depth >= 1;
+        } else if (arg == "--beam") {
+            ok = parseNumber(value, setup.search.beamWidth) && setup.search.beamWidth > 0;
+        } else if (arg == "--threads") {
+            ok = parseNumber(value, opts.threads);
+        } else if (arg == "--csv") {
+            opts.csv = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// the cross-entropy method over the lookahead bot's weights, from its
+// defaults; the same options give the same rows
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseOptions(argc, argv, opts)) {
+        printUsage();
+        return 1;
+    }
+    std::ofstream file;
+    if (!opts.csv.empty()) {
+        file.open(std::string(opts.csv));
+        if (!file) {
+            std::cerr << "cannot write " << opts.csv << '\n';
+            return 1;
+        }
+    }
+    std::ostream& csv = opts.csv.empty() ? std::cout : file;
+
+    task_pool::TaskPool pool(opts.threads);
+    weight_tuning::CrossEntropyTuner tuner(pool, opts.tuning);
+    weight_tuning::writeCsvHeader(csv);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t g = 0; g < opts.generations; ++g) {
+        auto candidates = tuner.step();
+        for (const auto& candidate : candidates) {
+            weight_tuning::writeCsvRow(csv, candidate);
+        }
+        csv.flush();
+        const auto& best = candidates.front().fitness;
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "generation " << g << ": best score " << best.meanScore
+                  << ", lines " << best.meanLines << ", " << best.gamesLost << " lost, "
+                  << seconds << " s on " << pool.threadCount() << " threads\n";
+    }
+
+    auto mean = weight_tuning::toVector(tuner.mean());
+    std::cerr << "mean weights:";
+    for (std::size_t w = 0; w < mean.size(); ++w) {
+        std::cerr << ' ' << weight_tuning::weightName(w) << '=' << mean[w];
+    }
+    std::cerr << '\n';
+    return 0;
+}